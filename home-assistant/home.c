@@ -7,8 +7,30 @@
 #include "hardware/i2c.h"
 #include "hardware/adc.h"
 #include "hardware/pwm.h"
+#include "pico/multicore.h"
+#include "pico/stdio_usb.h"
 #include "libs/neopixel_pio.h"
 #include "libs/ssd1306.h"
+#include "libs/adc_service.h"
+#include "libs/audio_dsp.h"
+#include "libs/cycle_counter.h"
+#include "libs/sound_detector.h"
+#include "libs/spsc_queue.h"
+#include "libs/action_player.h"
+#include "libs/kws.h"
+#include "libs/sound_classifier.h"
+#include "libs/rhythm.h"
+#include "libs/beat_tracker.h"
+#include "libs/scope.h"
+#include "libs/adpcm.h"
+#include "libs/voice_clip.h"
+#include "libs/pwm_audio.h"
+#include "libs/sequencer.h"
+#include "libs/note_pitch.h"
+#include "libs/synth.h"
+#include "libs/song_format.h"
+#include "libs/song_library.h"
+#include "libs/midi_stream.h"
 
 // Configuração doS Buzzers
 #define BUZZER_1 21
@@ -25,6 +47,8 @@
 // Configuração do Joystick
 #define X_AXIS 27
 #define Y_AXIS 26
+#define X_CHANNEL (X_AXIS - 26)     // Canais do ADC (GPIO 26 + canal)
+#define Y_CHANNEL (Y_AXIS - 26)
 
 // Configuração da Matriz de LEDs
 #define LEDS_MATRIX 7       // GPIO do NeoPixel
@@ -44,30 +68,99 @@ Display display;
 // ----------------------------------------------
 
 // --- Estruturas ---
+// O tabuleiro tem BOARD_W x BOARD_H células de CELL_PX pixels; uma célula é
+// identificada por y * BOARD_W + x. O corpo é um anel de células da cauda à
+// cabeça, então andar é escrever a nova cabeça e avançar a cauda, sem
+// deslocar o corpo. Um bit por célula marca o corpo (colisão em O(1)) e as
+// células livres ficam numa lista com o índice de cada uma, para tirar ou
+// devolver uma célula e sortear a comida em tempo constante.
+#define BOARD_W 25
+#define BOARD_H 12
+#define BOARD_CELLS (BOARD_W * BOARD_H)
+#define CELL_PX 5
+#define SNAKE_START 3       // Comprimento inicial
+
 typedef struct {
     int x, y;
 } Position;
 
 typedef struct {
-    int length;
-    Position body[50];
-    Position dir;
+    uint16_t body[BOARD_CELLS];        // Anel de células, da cauda à cabeça
+    uint16_t tail;                     // Posição da cauda no anel
+    uint16_t length;
+    uint32_t occupied[BOARD_H];        // Bit x da linha y: célula do corpo
+    uint16_t free_cells[BOARD_CELLS];  // Células fora do corpo, em qualquer ordem
+    uint16_t free_index[BOARD_CELLS];  // Posição de cada célula livre em free_cells
+    uint16_t free_count;
+    Position dir;                      // Direção em células
 } Snake;
 
 // --- Variáveis Globais ---
 Snake snake;
-Position food;
+uint16_t food;              // Célula da comida
 bool running;
+uint16_t dirty_cells[3];    // Células redesenhadas no passo: cauda, cabeça e comida
+int dirty_count;
+
+static inline uint16_t cell_at(int x, int y) {
+    return y * BOARD_W + x;
+}
+
+static inline bool cell_occupied(uint16_t cell) {
+    return snake.occupied[cell / BOARD_W] >> (cell % BOARD_W) & 1;
+}
+
+// Célula entra no corpo: sai da lista de livres trocando de lugar com a última
+void occupy_cell(uint16_t cell) {
+    uint16_t last = snake.free_cells[--snake.free_count];
+    
+    snake.free_cells[snake.free_index[cell]] = last;
+    snake.free_index[last] = snake.free_index[cell];
+    snake.occupied[cell / BOARD_W] |= 1u << (cell % BOARD_W);
+}
+
+// Célula sai do corpo e volta ao fim da lista de livres
+void release_cell(uint16_t cell) {
+    snake.free_index[cell] = snake.free_count;
+    snake.free_cells[snake.free_count++] = cell;
+    snake.occupied[cell / BOARD_W] &= ~(1u << (cell % BOARD_W));
+}
+
+// Acende ou apaga a célula no buffer e a marca para o próximo envio
+void draw_cell(uint16_t cell, bool set) {
+    ssd1306_set_pixel(display.buffer, cell % BOARD_W * CELL_PX, cell / BOARD_W * CELL_PX, set);
+    dirty_cells[dirty_count++] = cell;
+}
+
+uint16_t snake_head() {
+    return snake.body[(snake.tail + snake.length - 1) % BOARD_CELLS];
+}
+
+// Cobra de SNAKE_START células na linha 6, andando para a direita
+void reset_snake() {
+    memset(snake.occupied, 0, sizeof(snake.occupied));
+    for (uint16_t cell = 0; cell < BOARD_CELLS; cell++) {
+        snake.free_cells[cell] = cell;
+        snake.free_index[cell] = cell;
+    }
+    snake.free_count = BOARD_CELLS;
+    snake.tail = 0;
+    snake.length = 0;
+    for (int i = 0; i < SNAKE_START; i++) {
+        uint16_t cell = cell_at(4 + i, 6);
+        snake.body[snake.length++] = cell;
+        occupy_cell(cell);
+    }
+    snake.dir.x = 1;
+    snake.dir.y = 0;
+}
 
 
 void init_game() {
     // // Inicializa LEDs
     // neopixel_init(LEDS_MATRIX);
     
-    // Inicializa Joystick
-    adc_init();
-    adc_gpio_init(X_AXIS);
-    adc_gpio_init(Y_AXIS);
+    // O joystick é amostrado continuamente pelo serviço do ADC (ver init)
     
     // Inicializa Buzzer
     gpio_set_function(BUZZER_1, GPIO_FUNC_PWM);
@@ -106,23 +199,9 @@ void clear_all() {
 }
 
 // --- Gera nova comida ---
+// Sorteia entre as células livres: uma escolha, sem tentativas
 void generate_food() {
-    bool valid;
-    int i;
-    
-    do {
-        food.x = (rand() % 24 + 1) * 5;
-        food.y = (rand() % 12 + 1) * 5;
-        valid = true;
-        
-        // Verifica se a posição gerada coincide com alguma parte da cobra
-        for (i = 0; i < snake.length; i++) {
-            if (food.x == snake.body[i].x && food.y == snake.body[i].y) {
-                valid = false;
-                break;
-            }
-        }
-    } while (!valid);
+    food = snake.free_cells[rand() % snake.free_count];
 }
 
 
@@ -145,10 +224,8 @@ void play_snake_tone(uint frequency, uint duration_ms) {
 void read_joystick() {
     const int threshold = 2000; // Valor limite para definir movimento
     
-    adc_select_input(0);
-    int y_val = adc_read();
-    adc_select_input(1);
-    int x_val = adc_read();
+    int y_val = adc_service_value(Y_CHANNEL);
+    int x_val = adc_service_value(X_CHANNEL);
     
     // Normaliza para um range de -2048 a 2047
     int x_centered = x_val - 2048;
@@ -157,47 +234,87 @@ void read_joystick() {
     // Verifica se o joystick está sendo movido o suficiente
     if (y_centered > threshold && snake.dir.y == 0) {
         snake.dir.x = 0;
-        snake.dir.y = -5;
+        snake.dir.y = -1;
     } else if (y_centered < -threshold && snake.dir.y == 0) {
         snake.dir.x = 0;
-        snake.dir.y = 5;
+        snake.dir.y = 1;
     } else if (x_centered > threshold && snake.dir.x == 0) {
-        snake.dir.x = 5;
+        snake.dir.x = 1;
         snake.dir.y = 0;
     } else if (x_centered < -threshold && snake.dir.x == 0) {
-        snake.dir.x = -5;
+        snake.dir.x = -1;
         snake.dir.y = 0;
     }
 }
 
+// Um passo em O(1), qualquer que seja o comprimento. A célula da cauda não
+// conta como colisão, pois ela sai no mesmo passo (a comida nunca está no
+// corpo, então a cobra não cresce ali). O teste vem antes de mexer na
+// cauda, para o placar sair com o comprimento certo.
 void move_snake() {
-    Position new_head = {snake.body[0].x + snake.dir.x, snake.body[0].y + snake.dir.y};
+    uint16_t head = snake_head();
+    int x = head % BOARD_W + snake.dir.x;
+    int y = head / BOARD_W + snake.dir.y;
     
-    if (new_head.x < 0 || new_head.x >= 128 || new_head.y < 0 || new_head.y >= 64) {
+    if (x < 0 || x >= BOARD_W || y < 0 || y >= BOARD_H) {
         running = false;
         return;
     }
     
-    for (int i = snake.length - 1; i > 0; i--)
-    snake.body[i] = snake.body[i - 1];
-    snake.body[0] = new_head;
+    uint16_t new_head = cell_at(x, y);
+    uint16_t tail = snake.body[snake.tail];
+    bool eat = new_head == food;   // A comida nunca está no corpo
+    if (cell_occupied(new_head) && new_head != tail) {
+        running = false;   // Bateu no próprio corpo
+        return;
+    }
+    if (!eat) {
+        draw_cell(tail, false);
+        release_cell(tail);
+        snake.tail = (snake.tail + 1) % BOARD_CELLS;
+        snake.length--;
+    }
+    snake.body[(snake.tail + snake.length) % BOARD_CELLS] = new_head;
+    snake.length++;
+    occupy_cell(new_head);
+    draw_cell(new_head, true);
     
-    if (new_head.x == food.x && new_head.y == food.y) {
-        snake.length++;
+    if (eat) {
         play_snake_tone(660, 150);
+        if (snake.free_count == 0) {
+            running = false;   // Tabuleiro cheio: não há onde pôr comida
+            return;
+        }
         generate_food();
+        draw_cell(food, true);
     }
 }
 
 // --- Desenha no OLED ---
+// Quadro inteiro, só no início da partida
 void draw_game() {
     memset(display.buffer, 0, ssd1306_buffer_length);
     
-    for (int i = 0; i < snake.length; i++)
-    ssd1306_set_pixel(display.buffer, snake.body[i].x, snake.body[i].y, 1);
+    for (int i = 0; i < snake.length; i++) {
+        uint16_t cell = snake.body[(snake.tail + i) % BOARD_CELLS];
+        ssd1306_set_pixel(display.buffer, cell % BOARD_W * CELL_PX, cell / BOARD_W * CELL_PX, 1);
+    }
     
-    ssd1306_set_pixel(display.buffer, food.x, food.y, 1);
+    ssd1306_set_pixel(display.buffer, food % BOARD_W * CELL_PX, food / BOARD_W * CELL_PX, 1);
     render_on_display(display.buffer, &display.frame_area);
+    dirty_count = 0;
+}
+
+// A cada passo só mudam a cabeça, a cauda e a comida: envia o byte (uma
+// coluna de uma página) de cada uma, e não o quadro inteiro. O custo é o
+// mesmo com qualquer comprimento da cobra.
+void flush_game() {
+    for (int i = 0; i < dirty_count; i++) {
+        uint8_t x = dirty_cells[i] % BOARD_W * CELL_PX;
+        uint8_t page = dirty_cells[i] / BOARD_W * CELL_PX / ssd1306_page_height;
+        ssd1306_render_columns(display.buffer, page, x, x);
+    }
+    dirty_count = 0;
 }
 
 // --- Tela inicial ---
@@ -212,12 +329,7 @@ void start_game() {
         if (!gpio_get(BUTTON_A)) {
             // Inicialização da Snake
             running = true;
-            snake.length = 3;
-            snake.body[0] = (Position){30, 30};
-            snake.body[1] = (Position){25, 30};
-            snake.body[2] = (Position){20, 30};
-            snake.dir.x = 5; // Movendo para a direita
-            snake.dir.y = 0;
+            reset_snake();
             generate_food();
             return;
         } else if (!gpio_get(BUTTON_B)) {
@@ -235,7 +347,7 @@ void game_over() {
     ssd1306_draw_string(display.buffer, 25, 20, "GAME OVER!");
     
     char score_text[20];
-    sprintf(score_text, "Score: %d", snake.length - 3);
+    sprintf(score_text, "Score: %d", snake.length - SNAKE_START);
     ssd1306_draw_string(display.buffer, 25, 40, score_text);
     
     render_on_display(display.buffer, &display.frame_area);
@@ -258,10 +370,11 @@ void game_loop() {
             return;
         }
         
+        draw_game();
         while (running) {
             read_joystick();
             move_snake();
-            draw_game();
+            flush_game();
             sleep_ms(250); // Velocidade do jogo
         }
         
@@ -286,51 +399,101 @@ int run_emulator() {
 // Estrutura para representar uma nota
 typedef struct {
     const char *name;
-    uint frequency;
+    uint32_t millihertz;
+    NotePwm pwm;           // Divisor e topo do PWM, calculados na compilação
 } Note;
 
-// Lista de notas
+// Lista de notas (temperamento igual, de libs/note_pitch.h)
+#define NOTE_ENTRY(name, mhz) {name, mhz, NOTE_PWM(mhz)},
 Note NOTES[] = {
-    {"C0", 16}, {"C#0", 17}, {"D0", 18}, {"D#0", 19}, {"E0", 21}, {"F0", 22}, {"F#0", 23}, {"G0", 25}, {"G#0", 26}, {"A0", 28}, {"A#0", 29}, {"B0", 31},
-    {"C1", 33}, {"C#1", 35}, {"D1", 37}, {"D#1", 39}, {"E1", 41}, {"F1", 44}, {"F#1", 46}, {"G1", 49}, {"G#1", 52}, {"A1", 55}, {"A#1", 58}, {"B1", 62},
-    {"C2", 65}, {"C#2", 69}, {"D2", 73}, {"D#2", 78}, {"E2", 82}, {"F2", 87}, {"F#2", 92}, {"G2", 98}, {"G#2", 104}, {"A2", 110}, {"A#2", 117}, {"B2", 123},
-    {"C3", 131}, {"C#3", 139}, {"D3", 147}, {"D#3", 156}, {"E3", 165}, {"F3", 175}, {"F#3", 185}, {"G3", 196}, {"G#3", 208}, {"A3", 220}, {"A#3", 233}, {"B3", 247},
-    {"C4", 262}, {"C#4", 277}, {"D4", 294}, {"D#4", 311}, {"E4", 330}, {"F4", 349}, {"F#4", 370}, {"G4", 392}, {"G#4", 415}, {"A4", 440}, {"A#4", 466}, {"B4", 494},
-    {"C5", 523}, {"C#5", 554}, {"D5", 587}, {"D#5", 622}, {"E5", 659}, {"F5", 698}, {"F#5", 740}, {"G5", 784}, {"G#5", 831}, {"A5", 880}, {"A#5", 932}, {"B5", 988},
-    {"C6", 1047}, {"C#6", 1109}, {"D6", 1175}, {"D#6", 1245}, {"E6", 1319}, {"F6", 1397}, {"F#6", 1480}, {"G6", 1568}, {"G#6", 1661}, {"A6", 1760}, {"A#6", 1865}, {"B6", 1976},
-    {"C7", 2093}, {"C#7", 2217}, {"D7", 2349}, {"D#7", 2489}, {"E7", 2637}, {"F7", 2794}, {"F#7", 2960}, {"G7", 3136}, {"G#7", 3322}, {"A7", 3520}, {"A#7", 3729}, {"B7", 3951},
-    {"REST", 0}
+    NOTE_LIST(NOTE_ENTRY)
+    {"REST", 0, {0, 0}}
 };
 
-typedef struct {
-    const Note *note;
-    uint duration;
-} Tone;
+// Músicas no formato compacto de libs/song_format.h: uma palavra de 16
+// bits (2 bytes) por nota, com andamento, transposição e repetições. As de songs/ são
+// compiladas pelo host/song_compiler para songs/song_table.c; estas duas são
+// escritas à mão. A 75 tempos por minuto o tique é de 50 ms.
+#define N SONG_NOTE
+
+// A segunda metade é a primeira uma terça maior acima: a transposição no
+// fim do trecho vale para a repetição
+static const uint16_t imperial_march_melody[] = {
+    SONG_TEMPO(75),
+    SONG_REPEAT,
+        N(52, 11), N(52, 11), N(56, 8), N(60, 4), N(52, 11), N(56, 8), N(60, 4), N(52, 21),
+        SONG_TRANSPOSE(4),
+    SONG_LOOP(2),
+    SONG_END
+};
 
-typedef struct {
-    const Tone *sheet;
-    uint8_t length;
-} Song;
-
-// static const Tone mario_theme_sheet[] = {
-//     {&NOTES[64], 125}, {&NOTES[64], 125}, {&NOTES[88], 125}, {&NOTES[64], 125},
-//     {&NOTES[88], 125}, {&NOTES[72], 125}, {&NOTES[64], 125}, {&NOTES[88], 125},
-//     {&NOTES[78], 250}, {&NOTES[88], 125}, {&NOTES[76], 250}, {&NOTES[88], 250},
-//     {&NOTES[72], 125}, {&NOTES[88], 125}, {&NOTES[64], 125}, {&NOTES[60], 125},
-//     {&NOTES[67], 125}, {&NOTES[76], 250}, {&NOTES[72], 125}, {&NOTES[67], 125},
-//     {&NOTES[64], 250}, {&NOTES[88], 250}
-// };
-
-static const Tone imperial_march_sheet[] = {
-    {&NOTES[52], 500}, {&NOTES[52], 500}, {&NOTES[56], 350}, {&NOTES[60], 150},
-    {&NOTES[52], 500}, {&NOTES[56], 350}, {&NOTES[60], 150}, {&NOTES[52], 1000},
-    {&NOTES[56], 500}, {&NOTES[56], 500}, {&NOTES[60], 350}, {&NOTES[64], 150},
-    {&NOTES[56], 500}, {&NOTES[60], 350}, {&NOTES[64], 150}, {&NOTES[56], 1000}
+// Linhas de baixo: ritmo próprio, mesma duração total da melodia
+static const uint16_t imperial_march_bass[] = {
+    SONG_TEMPO(75),
+    SONG_REPEAT,
+        SONG_REPEAT, N(40, 13), SONG_LOOP(6),
+        SONG_TRANSPOSE(4),
+    SONG_LOOP(2),
+    SONG_END
+};
+
+// Duração 0: a nota soa junto com a seguinte (acorde). Tique de 25 ms.
+static const uint16_t chord_progression_melody[] = {
+    SONG_TEMPO(150),
+    N(48, 0), N(52, 0), N(55, 38),   // C
+    N(43, 0), N(47, 0), N(50, 38),   // G
+    N(45, 0), N(48, 0), N(52, 38),   // Am
+    N(41, 0), N(45, 0), N(48, 38),   // F
+    SONG_END
+};
+
+static const uint16_t chord_progression_bass[] = {
+    SONG_TEMPO(150),
+    N(36, 19), N(36, 19), N(31, 19), N(31, 19),
+    N(33, 19), N(33, 19), N(29, 19), N(29, 19),
+    SONG_END
 };
 
-// const Song mario_theme = {mario_theme_sheet, sizeof(mario_theme_sheet) / sizeof(Tone)};
-const Song imperial_march = {imperial_march_sheet, sizeof(imperial_march_sheet) / sizeof(Tone)};
-const Song *songs[] = {&imperial_march};
+#undef N
+
+// Instrumento pelo número General MIDI
+static const PackedSong builtin_songs[] = {
+    {"Imperial March", 61, imperial_march_melody, imperial_march_bass, 7800},
+    {"Chords", 19, chord_progression_melody, chord_progression_bass, 3800},
+};
+#define BUILTIN_SONGS (int)(sizeof(builtin_songs) / sizeof(PackedSong))
+
+// Timbres: forma de onda, ataque, decaimento, sustentação (Q15), liberação e volume
+static const SynthInstrument brass = {SYNTH_WAVE_SAW, 15, 120, 22000, 60, 20000};
+static const SynthInstrument organ = {SYNTH_WAVE_ORGAN, 30, 200, 26000, 250, 10000};
+static const SynthInstrument chip = {SYNTH_WAVE_SQUARE, 5, 60, 20000, 40, 12000};
+static const SynthInstrument piano = {SYNTH_WAVE_SINE, 5, 600, 6000, 200, 24000};
+
+// Timbre pela família General MIDI (8 programas cada)
+static const SynthInstrument *instrument_for_program(uint8_t program) {
+    switch (program / 8) {
+    case 2: return &organ;   // Órgãos
+    case 7: return &brass;   // Metais
+    case 10: return &chip;   // Solos de sintetizador (padrão do RTTTL)
+    default: return &piano;
+    }
+}
+
+int library_songs = 0;   // Músicas da biblioteca na flash (0: sem biblioteca)
+
+int song_count() {
+    return library_songs ? library_songs : BUILTIN_SONGS + compiled_song_count;
+}
+
+// Música index da biblioteca na flash ou, sem ela, das embutidas no programa.
+// Tempo constante: as vozes continuam na flash, só os ponteiros são copiados.
+PackedSong song_at(int index) {
+    PackedSong song;
+    
+    if (library_songs && song_library_song(index, &song))
+        return song;
+    return index < BUILTIN_SONGS ? builtin_songs[index] : compiled_songs[index - BUILTIN_SONGS];
+}
 
 // Definição de cores
 const uint8_t RED[3] = {25, 0, 0};
@@ -347,39 +510,58 @@ int index_[5][5] = {
     {0, 9, 10, 19, 20}   // Coluna 4
 };
 
-bool running = false;
-// bool next_song = false;
-bool back = false;
+#define NOTE_GAP_MS 50   // Silêncio entre notas
+#define SYNTH_RATE 22050 // Taxa do sintetizador no PWM do buzzer 1
 
-void button_callback(uint gpio, uint32_t events) {
-    if (gpio == BUTTON_A)
-    running = !running;
-    else if (gpio == BUTTON_B)
-    back = true;
-    
+Synth synth;             // Vozes tocadas na interrupção do DMA do pwm_audio
+
+volatile bool back = false;
+uint32_t last_press_us = 0;
+int current_song = 0;
+SongDecoder song_voices[SEQ_VOICES];  // Leitura de cada voz (avança na interrupção do alarme)
+bool song_playing = false;      // Tocando (ou pausada) desde o A; recomeça ao terminar
+bool midi_live = false;         // Tocando o MIDI que chega pela USB (veja update_midi)
+
+// Próxima nota da voz (0: melodia, 1: baixo) para o sequenciador
+bool next_song_tone(uint8_t voice, SeqTone *tone) {
+    return song_decoder_next(&song_voices[voice], &tone->note, &tone->duration_ms);
 }
 
-void init_player() {
-    // // Inicializa LEDs
-    // neopixel_init(LEDS_MATRIX);
+void start_song(int index) {
+    PackedSong song = song_at(index);
     
-    // Interrupções nos botões 
-    gpio_set_irq_enabled_with_callback(BUTTON_A, GPIO_IRQ_EDGE_FALL, true, &button_callback);
-    gpio_set_irq_enabled_with_callback(BUTTON_B, GPIO_IRQ_EDGE_FALL, true, &button_callback);
-    
-    // Inicializa Buzzer
-    gpio_set_function(BUZZER_1, GPIO_FUNC_PWM);
-    uint slice_num_1 = pwm_gpio_to_slice_num(BUZZER_1);
-    gpio_set_function(BUZZER_2, GPIO_FUNC_PWM);
-    uint slice_num_2 = pwm_gpio_to_slice_num(BUZZER_2);
-    pwm_config config = pwm_get_default_config();
-    pwm_config_set_clkdiv(&config, 32.0f); // Ajusta divisor de clock
-    pwm_init(slice_num_1, &config, true);
-    pwm_init(slice_num_2, &config, true);
-    pwm_set_gpio_level(BUZZER_1, 0); // Desliga o PWM inicialmente
-    pwm_set_gpio_level(BUZZER_2, 0); // Desliga o PWM inicialmente
+    current_song = index;
+    song_decoder_init(&song_voices[0], song.melody);
+    song_decoder_init(&song_voices[1], song.bass);
+    song_playing = true;
+    synth_set_instrument(&synth, instrument_for_program(song.program));
+    sequencer_play(next_song_tone);
 }
 
+// A: tocar/pausar, B: sair. Atendidos na própria interrupção do botão, então
+// a música para ou volta na hora; bordas em menos de 200 ms são repique.
+void button_callback(uint gpio, uint32_t events) {
+    uint32_t now = time_us_32();
+    
+    if (now - last_press_us < 200000)
+        return;
+    last_press_us = now;
+    if (gpio == BUTTON_A) {
+        if (midi_live)
+            return;   // O host está tocando
+        if (sequencer_paused())
+            sequencer_resume();
+        else if (sequencer_active())
+            sequencer_pause();
+        else
+            start_song(current_song);
+    }
+    else if (gpio == BUTTON_B) {
+        song_playing = false;
+        sequencer_stop();
+        back = true;
+    }
+}
 
 // --- Acende LEDs conforme notas
 void light_music_leds(uint frequency, uint duration) {
@@ -422,88 +604,311 @@ void light_music_leds(uint frequency, uint duration) {
     neopixel_write();
 }
 
-void play_music_tone(uint frequency, uint duration_ms) {
-    if (frequency > 0) {
-        uint slice_num_1 = pwm_gpio_to_slice_num(BUZZER_1);
-        uint slice_num_2 = pwm_gpio_to_slice_num(BUZZER_2);
-        uint32_t clock_freq = clock_get_hz(clk_sys);
-        uint32_t top_1 = (clock_freq / 32.0f) / (frequency / 4) - 1;
-        uint32_t top_2 = (clock_freq / 32.0f) / (frequency / 8) - 1;
-        
-        pwm_set_wrap(slice_num_1, top_1 / 2);
-        pwm_set_gpio_level(BUZZER_1, top_1 / 8); // reduz duty cycle
-        // pwm_set_gpio_level(BUZZER_1, 12000); 
-        pwm_set_wrap(slice_num_2, top_2 / 4);
-        pwm_set_gpio_level(BUZZER_2, top_2 / 16); // reduz duty cycle
-        // pwm_set_gpio_level(BUZZER_1,6000); 
+// Voz 0 (melodia) no sintetizador do buzzer 1, onde as notas de um acorde se
+// somam; voz 1 (baixo) em onda quadrada no buzzer 2, com 25% de ciclo ativo.
+// SEQ_SILENCE libera a voz. Chamada pelo sequenciador na interrupção do
+// alarme: só consulta as tabelas, sem contas.
+void play_music_tone(uint8_t voice, uint8_t note) {
+    if (voice == 0) {
+        if (note < NOTE_COUNT)
+            synth_note_on(&synth, NOTES[note].millihertz);
+        else if (note == SEQ_SILENCE)
+            synth_release_all(&synth);
+        return;
     }
     
-    sleep_ms(duration_ms);
-    pwm_set_gpio_level(BUZZER_1, 0); // Desliga o som após a duração
-    pwm_set_gpio_level(BUZZER_2, 0); // Desliga o som após a duração
-    sleep_ms(50); // Pausa entre notas
+    if (note >= NOTE_COUNT) {
+        pwm_set_gpio_level(BUZZER_2, 0);
+        return;
+    }
+    const NotePwm *pwm = &NOTES[note].pwm;
+    uint slice_num_2 = pwm_gpio_to_slice_num(BUZZER_2);
+    pwm_set_clkdiv_int_frac(slice_num_2, pwm->div16 >> 4, pwm->div16 & 0xF);
+    pwm_set_wrap(slice_num_2, pwm->wrap);
+    pwm_set_gpio_level(BUZZER_2, (pwm->wrap + 1) / 4);
 }
 
+// Bloco seguinte do áudio do buzzer 1 (interrupção do DMA)
+int render_synth(int16_t *samples, int n) {
+    synth_render(&synth, samples, n);
+    return n;
+}
 
-void pause_song() {
-    pwm_set_gpio_level(BUZZER_1, 0); // Desliga o som após a duração
-    pwm_set_gpio_level(BUZZER_2, 0); // Desliga o som após a duração
+// --- MIDI ao vivo pela USB ---
+// Mensagens MIDI no terminal USB põem o player em modo ao vivo: o canal 2 vai
+// para o baixo em onda quadrada do buzzer 2 e os demais (menos a bateria, no
+// canal 10) para o sintetizador do buzzer 1. A chegada é carimbada na
+// interrupção da USB e o midi_stream toca cada mensagem com latência fixa.
+#define MIDI_BASS_CHANNEL 1
+#define MIDI_DRUM_CHANNEL 9
+#define MIDI_IDLE_MS 3000        // Sem mensagens por esse tempo: volta às músicas
+
+typedef struct {
+    MidiMessage message;
+    uint64_t arrival_us;           // Chegada do pacote USB que a trouxe
+} MidiInput;
+
+MidiParser midi_parser;
+absolute_time_t midi_idle_at;
+uint8_t midi_bass_note = SEQ_SILENCE;  // Nota soando no buzzer 2
+MidiInput midi_input_items[MIDI_QUEUE_SIZE];
+SpscQueue midi_input;                  // Interrupção da USB -> laço principal
+volatile uint32_t midi_input_dropped = 0;
+
+// Interrupção da USB: lê e interpreta os bytes assim que chegam, e cada
+// mensagem leva o instante do seu próprio pacote. Ler no laço principal
+// dava a todas as mensagens acumuladas durante uma demora dele (a tela, as
+// estatísticas) o mesmo instante, e elas tocavam juntas.
+void usb_chars_available(void *param) {
+    uint64_t arrival = time_us_64();
+    int c;
+    
+    while ((c = getchar_timeout_us(0)) >= 0) {
+        MidiInput input = {.arrival_us = arrival};
+        if (midi_parse(&midi_parser, c, &input.message) && !spsc_push(&midi_input, &input))
+            midi_input_dropped++;
+    }
 }
 
-void play_song(Song song) {
-    for (int i = 0; i < song.length; i++) {
-        clear_all();
-        if (back) 
-            return;
-        while (!running) {
-            // pause_song();
-            sleep_ms(200);
-            if (back) 
-                return;
+// Toca uma mensagem no prazo (interrupção do alarme do midi_stream)
+void play_midi(const MidiMessage *message) {
+    uint8_t type = message->status & 0xF0, channel = message->status & 0x0F;
+    int note = message->data1 - 12;   // Nota MIDI 12 é C0
+    
+    if (message->status == 0xFC || (type == 0xB0 && (message->data1 == 120 || message->data1 == 123))) {
+        // Stop ou "todas as notas desligadas"
+        synth_release_all(&synth);
+        play_music_tone(1, SEQ_SILENCE);
+        midi_bass_note = SEQ_SILENCE;
+        return;
+    }
+    if (channel == MIDI_DRUM_CHANNEL)
+        return;
+    if (type == 0xC0 && channel != MIDI_BASS_CHANNEL) {
+        synth_set_instrument(&synth, instrument_for_program(message->data1));
+        return;
+    }
+    if ((type != 0x90 && type != 0x80) || note < 0 || note >= NOTE_COUNT)
+        return;
+    
+    if (channel == MIDI_BASS_CHANNEL) {
+        if (type == 0x90) {
+            play_music_tone(1, note);
+            midi_bass_note = note;
+        } else if (note == midi_bass_note) {
+            play_music_tone(1, SEQ_SILENCE);
+            midi_bass_note = SEQ_SILENCE;
         }
-        play_music_tone(song.sheet[i].note->frequency, song.sheet[i].duration);
-        light_music_leds(song.sheet[i].note->frequency, song.sheet[i].duration);
+    } else if (type == 0x90)
+        synth_note_on(&synth, NOTES[note].millihertz);
+    else
+        synth_note_off(&synth, NOTES[note].millihertz);
+}
+
+// Para o modo ao vivo e solta as notas que ficaram
+void stop_midi() {
+    midi_player_stop();
+    synth_release_all(&synth);
+    play_music_tone(1, SEQ_SILENCE);
+    midi_bass_note = SEQ_SILENCE;
+    midi_live = false;
+}
+
+// Passa as mensagens lidas na interrupção da USB para o buffer de jitter;
+// true se chegou alguma. A primeira interrompe a música e liga o modo ao vivo.
+bool update_midi() {
+    MidiInput input;
+    bool received = false;
+    
+    while (spsc_pop(&midi_input, &input)) {
+        if (!midi_live) {
+            song_playing = false;
+            sequencer_stop();
+            midi_player_start(play_midi);
+            midi_input_dropped = 0;
+            midi_live = true;
+        }
+        midi_player_push(&input.message, input.arrival_us);
+        received = true;
     }
+    return received;
+}
+
+void init_player() {
+    // // Inicializa LEDs
+    // neopixel_init(LEDS_MATRIX);
+    
+    // Interrupções nos botões 
+    gpio_set_irq_enabled_with_callback(BUTTON_A, GPIO_IRQ_EDGE_FALL, true, &button_callback);
+    gpio_set_irq_enabled_with_callback(BUTTON_B, GPIO_IRQ_EDGE_FALL, true, &button_callback);
+    
+    // Buzzer 2: baixo em onda quadrada pelo divisor e topo de cada nota
+    gpio_set_function(BUZZER_2, GPIO_FUNC_PWM);
+    uint slice_num_2 = pwm_gpio_to_slice_num(BUZZER_2);
+    pwm_config config = pwm_get_default_config();
+    pwm_init(slice_num_2, &config, true);
+    pwm_set_gpio_level(BUZZER_2, 0); // Desliga o PWM inicialmente
+    
+    // Buzzer 1: DAC PWM alimentado pelo sintetizador
+    synth_init(&synth, SYNTH_RATE);
+    pwm_audio_start(BUZZER_1, SYNTH_RATE, render_synth);
+    
+    sequencer_init(play_music_tone, NOTE_GAP_MS);
+    back = false;
+    song_playing = false;
+    
+    // MIDI ao vivo pelo terminal USB
+    midi_parser_init(&midi_parser);
+    spsc_init(&midi_input, midi_input_items, sizeof(MidiInput), MIDI_QUEUE_SIZE);
+    midi_live = false;
+    stdio_set_chars_available_callback(usb_chars_available, NULL);
+    
+    // Biblioteca gravada na flash; sem ela, as músicas embutidas
+    library_songs = song_library_open();
+    if (current_song >= song_count())
+        current_song = 0;
+}
+
+// Título, posição na lista e duração da música escolhida (páginas 4 e 5)
+void draw_song_info() {
+    PackedSong song = song_at(current_song);
+    char text[17];
+    
+    memset(display.buffer + ssd1306_width * 4, 0, ssd1306_width * 2);
+    snprintf(text, sizeof(text), "%.16s", song.title);
+    ssd1306_draw_string(display.buffer, 0, 32, text);
+    snprintf(text, sizeof(text), "%d/%d %lu:%02lu", current_song + 1, song_count(),
+             (unsigned long)(song.duration_ms / 60000), (unsigned long)(song.duration_ms / 1000 % 60));
+    ssd1306_draw_string(display.buffer, 0, 40, text);
 }
 
 void display_music_menu() {
     memset(display.buffer, 0, ssd1306_buffer_length);
-    ssd1306_draw_string(display.buffer, 25, 10, "MUSIC PLAYER");
-    ssd1306_draw_string(display.buffer, 10, 30, "A: Play/Pause");
-    ssd1306_draw_string(display.buffer, 10, 40, "B: Exit");
+    ssd1306_draw_string(display.buffer, 25, 0, "MUSIC PLAYER");
+    draw_song_info();
+    ssd1306_draw_string(display.buffer, 0, 56, "A:Play B:Exit");
+    render_on_display(display.buffer, &display.frame_area);
+}
+
+// Vozes ativas e fração do core0 gasta no sintetizador
+void show_synth_status() {
+    char text[17];
+    uint32_t block_cycles = clock_get_hz(clk_sys) / SYNTH_RATE * PWM_AUDIO_BLOCK;
+    uint32_t permille = (uint64_t)synth.cost * 1000 / block_cycles;
+    
+    snprintf(text, sizeof(text), "Synth %dv %lu.%lu%%", synth_active_voices(&synth),
+             (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+    memset(display.buffer + ssd1306_width * 2, 0, ssd1306_width);  // Página da linha y = 16
+    ssd1306_draw_string(display.buffer, 10, 16, text);
+    ssd1306_render_pages(display.buffer, 2, 2);
+}
+
+// Escolhe a música; se alguma está tocando, a escolhida começa na hora
+void select_song(int index) {
+    if (song_playing)
+        start_song(index);
+    else
+        current_song = index;
+    draw_song_info();
+    ssd1306_render_pages(display.buffer, 4, 5);
+}
+
+void display_midi_screen() {
+    memset(display.buffer, 0, ssd1306_buffer_length);
+    ssd1306_draw_string(display.buffer, 30, 0, "MIDI LIVE");
+    ssd1306_draw_string(display.buffer, 0, 56, "B: Exit");
     render_on_display(display.buffer, &display.frame_area);
 }
 
+// Contadores do último segundo no display (páginas 4 a 6) e na USB, para o
+// host medir a latência e o jitter de ponta a ponta
+void show_midi_stats() {
+    MidiStats stats;
+    char text[17];
+    
+    midi_player_stats(&stats);
+    stats.dropped += midi_input_dropped;   // Também as que não couberam na fila da USB
+    memset(display.buffer + ssd1306_width * 4, 0, ssd1306_width * 3);
+    snprintf(text, sizeof(text), "Rx %lu Late %lu", (unsigned long)stats.received, (unsigned long)stats.late);
+    ssd1306_draw_string(display.buffer, 0, 32, text);
+    snprintf(text, sizeof(text), "Drop %lu Max %lums", (unsigned long)stats.dropped,
+             (unsigned long)(stats.max_late_us / 1000));
+    ssd1306_draw_string(display.buffer, 0, 40, text);
+    snprintf(text, sizeof(text), "Jitter %lu us", (unsigned long)stats.clock_jitter_us);
+    ssd1306_draw_string(display.buffer, 0, 48, text);
+    ssd1306_render_pages(display.buffer, 4, 6);
+    
+    printf("midi received=%lu played=%lu late=%lu dropped=%lu max_late_us=%lu clock_jitter_us=%lu latency_us=%u\n",
+           (unsigned long)stats.received, (unsigned long)stats.played, (unsigned long)stats.late,
+           (unsigned long)stats.dropped, (unsigned long)stats.max_late_us,
+           (unsigned long)stats.clock_jitter_us, MIDI_LATENCY_US);
+}
+
+// O som corre no alarme; o laço só acende os LEDs no início de cada nota,
+// recomeça a música quando ela termina, lê o joystick (a cada 1 ms) para
+// navegar pela lista e passa o MIDI da USB para o buffer de jitter
 void music_player() {
-    int current_song_index = 0;
-    int n = sizeof(songs) / sizeof(Song*);
+    int n = song_count();
+    absolute_time_t next_status = make_timeout_time_ms(1000);
     display_music_menu();
     
-    while (true) {
-        if (running) {
-            // printf("Running!\n");
-            sleep_ms(50);
-            play_song(*songs[current_song_index]);
+    while (!back) {
+        bool was_live = midi_live;
+        if (update_midi())
+            midi_idle_at = make_timeout_time_ms(MIDI_IDLE_MS);
+        if (midi_live && !was_live)
+            display_midi_screen();
+        if (midi_live && time_reached(midi_idle_at)) {
+            stop_midi();
+            display_music_menu();
+        }
+        if (time_reached(next_status)) {
+            show_synth_status();
+            if (midi_live)
+                show_midi_stats();
+            next_status = make_timeout_time_ms(1000);
         }
+        if (midi_live) {
+            sleep_ms(1);
+            continue;
+        }
+        // A melodia limpa a matriz a cada nota; o baixo acende sua coluna por cima
+        SeqTone tone;
+        for (uint8_t voice = 0; voice < SEQ_VOICES; voice++) {
+            if (!sequencer_poll(voice, &tone))
+                continue;
+            if (voice == 0)
+                clear_all();
+            if (tone.note < NOTE_COUNT)
+                light_music_leds(NOTES[tone.note].millihertz / 1000, tone.duration_ms);
+        }
+        if (song_playing && !sequencer_active())
+            start_song(current_song);  // As duas vozes terminaram: recomeça junto
         
-        if (back) {
+        // Lados: música seguinte ou anterior; cima e baixo: dez adiante ou atrás
+        int x = adc_service_value(X_CHANNEL) - 2048;
+        int y = adc_service_value(Y_CHANNEL) - 2048;
+        int step = x > 1500 ? 1 : x < -1500 ? -1 : y > 1500 ? 10 : y < -1500 ? -10 : 0;
+        if (step) {
+            select_song(((current_song + step) % n + n) % n);
             sleep_ms(300);
-            running = false;
-            back = false;
-            memset(display.buffer, 0, ssd1306_buffer_length);
-            render_on_display(display.buffer, &display.frame_area);
-            clear_all();
-            return;
         }
-        
-        pause_song(); // Garante que o som pare se estiver pausado
-        sleep_ms(200); 
+        sleep_ms(1);
     }
+    
+    stop_midi();
+    pwm_audio_stop();
+    sleep_ms(300);
+    back = false;
+    memset(display.buffer, 0, ssd1306_buffer_length);
+    render_on_display(display.buffer, &display.frame_area);
+    clear_all();
 }
 
 int play_songs() {
     init_player();
     music_player();
+    stdio_set_chars_available_callback(NULL, NULL);
     gpio_set_irq_enabled_with_callback(BUTTON_A, GPIO_IRQ_EDGE_FALL, false, &button_callback);
     gpio_set_irq_enabled_with_callback(BUTTON_B, GPIO_IRQ_EDGE_FALL, false, &button_callback);
 
@@ -518,23 +923,233 @@ int play_songs() {
 // ----------------------------------------------
 
 // Configuração do Microfone
-#define MIC_PIN 28  
-#define MIC_CHANNEL 2
-#define OFFSET 2048      // ADC Pico W vai de 0 a 4095, offset no meio
-#define CLAP_THRESHOLD 0.30 
-#define NOISE_THRESHOLD 0.60
+#define MIC_CHANNEL 2   // GPIO 28
+
+#define SOUND_QUEUE_SIZE 32 // Eventos em trânsito do core1 para o core0
+#define SCOPE_QUEUE_SIZE 8  // Linhas da visualização em trânsito (128 ms)
+#define CAPTURE_QUEUE_SIZE 32 // Quadros ADPCM em trânsito (512 ms, cobre as pausas da interface)
 
 // Estado global
 bool listening = false;   // Se a detecção de som está ativa
 bool leds_on = false;     // LEDs da matriz
-absolute_time_t last_clap_time;
-absolute_time_t last_noise_time;
+DcFilter mic_dc;          // Remoção do nível DC do microfone
+int16_t mic_block[MIC_BLOCK_SIZE] __attribute__((aligned(4)));
+SoundDetector detector;   // Detector de inícios e sequência de palmas
+
+// Eventos do detector (core1, produtor) para a interface (core0, consumidor)
+SoundEvent sound_event_items[SOUND_QUEUE_SIZE];
+SpscQueue sound_events;
+volatile bool core1_running = false;   // Pipeline do core1 (detector ou luzes) ativo
+volatile bool core1_stopped = true;
+
+// Visualização do microfone na tela: o core1 gera as linhas, o core0 desenha
+Scope scope;
+ScopeRow scope_row_items[SCOPE_QUEUE_SIZE];
+SpscQueue scope_rows;
+volatile uint8_t scope_view = SCOPE_OFF;  // ScopeView pedida pelo core0
+uint8_t scope_line = 0;                   // Próxima linha da RAM da tela (core0)
+
+// Captura do microfone pela USB: o core1 codifica, o core0 envia
+uint8_t capture_items[CAPTURE_QUEUE_SIZE][ADPCM_FRAME_BYTES];
+SpscQueue capture_frames;
+volatile bool capture_on = false;         // Ligada pelo host ('c' liga, 's' desliga)
+int16_t capture_samples[ADPCM_FRAME_SAMPLES];
+uint16_t capture_fill = 0;
+uint16_t capture_seq = 0;                 // Avança mesmo com a fila cheia: o host vê a lacuna
+AdpcmState capture_state;
+
+// Pedidos do modo de ensino, do core0 para o core1 (dono do índice de sons
+// e dos códigos): em fila, para que um pedido feito antes de o core1 pegar
+// o anterior não se perca
+#define TEACH_QUEUE_SIZE 8
+
+typedef struct {
+    bool codes;             // Códigos rítmicos (senão, sons)
+    int8_t request;         // Slot a gravar (>= 0), cancelar (-1) ou apagar (-2 - slot)
+} TeachRequest;
+
+TeachRequest teach_items[TEACH_QUEUE_SIZE];
+SpscQueue teach_requests;
+
+// Sons ensinados por exemplo (mantidos entre as sessões do detector)
+SoundClassifier classifier;
+bool classifier_ready = false;
+
+// Códigos rítmicos gravados (também mantidos entre as sessões)
+RhythmMatcher rhythm;
+bool rhythm_ready = false;
+SoundEvent held_clap;     // Duplo aplauso retido até a sequência de batidas terminar
+bool clap_held = false;
+
+#ifdef KEYWORD_SPOTTING
+KwsModel kws_model;       // Pesos da DS-CNN (de teste até haver um modelo treinado)
+KwsSpotter spotter;       // MFCC + inferência a cada KWS_STRIDE_FRAMES
+volatile uint32_t kws_worst_cost = 0;  // Pior bloco com inferência, em CYCLE_COUNTER_UNIT
+#endif
+
+#ifdef DSP_BENCHMARK
+void benchmark_vu_path();
+#endif
+
+// Publica o fim de uma sequência de batidas. O duplo aplauso retido só sai
+// se a sequência terminou com exatamente duas batidas.
+void publish_rhythm(RhythmResult result, const RhythmMatch *beat, uint32_t t) {
+    if (result == RHYTHM_NONE)
+        return;
+    if (result != RHYTHM_UNMATCHED) {
+        SoundEvent event = {result == RHYTHM_MATCH ? SOUND_EVENT_RHYTHM : SOUND_EVENT_RHYTHM_RECORDED,
+                            t, beat->error, (uint8_t)beat->pattern};
+        spsc_push(&sound_events, &event);
+    }
+    else if (clap_held && beat->onsets == 2)
+        spsc_push(&sound_events, &held_clap);
+    clap_held = false;
+}
+
+// Encaminha um evento do detector para o core0. Cada início também é uma
+// batida para os códigos rítmicos; havendo códigos, o duplo aplauso espera a
+// sequência terminar para não disparar no começo de um código.
+void route_sound_event(const SoundEvent *event) {
+    if (event->type == SOUND_EVENT_ONSET) {
+        RhythmMatch beat;
+        publish_rhythm(rhythm_onset(&rhythm, event->sample, &beat), &beat, event->sample);
+    }
+    if (event->type == SOUND_EVENT_DOUBLE_CLAP && (rhythm_stored(&rhythm) || rhythm.recording >= 0)) {
+        held_clap = *event;
+        clap_held = true;
+        return;
+    }
+    spsc_push(&sound_events, event);
+}
+
+// Acumula um bloco cru do ADC no quadro de captura. As amostras vão em 16
+// bits (contagens - OFFSET, vezes 16), a mesma escala que o wav_replay
+// desfaz, então a gravação volta ao detector com as contagens originais.
+void capture_block(const uint16_t *block) {
+    for (int i = 0; i < MIC_BLOCK_SIZE; i++)
+        capture_samples[capture_fill++] = (int16_t)(((int32_t)block[i] - OFFSET) * 16);
+    if (capture_fill < ADPCM_FRAME_SAMPLES)
+        return;
+    
+    uint8_t frame[ADPCM_FRAME_BYTES];
+    adpcm_frame_pack(frame, capture_seq++, MIC_SAMPLE_RATE, &capture_state, capture_samples);
+    spsc_push(&capture_frames, frame);
+    capture_fill = 0;
+}
+
+// Pipeline contínuo no core1: remoção de DC e detecção sobre os blocos do
+// serviço do ADC. Nada do core0 (tela, alarme, LEDs) atrasa a análise; a
+// interrupção do DMA só separa os canais e acorda o core1.
+void detector_core1_main() {
+    cycle_counter_init();   // SysTick deste núcleo, para o custo dos kernels
+    adc_service_flush();
+#ifdef DSP_BENCHMARK
+    benchmark_vu_path();
+#endif
+    
+    SoundEvent events[SOUND_MAX_EVENTS];
+    while (core1_running) {
+        const uint16_t *block = adc_service_wait_block();
+        uint32_t start = (adc_service_blocks_read() - 1) * MIC_BLOCK_SIZE;
+        
+        if (capture_on)
+            capture_block(block);
+        else
+            capture_fill = 0;
+        
+        dsp_dc_remove(&mic_dc, block, mic_block, MIC_BLOCK_SIZE);
+        int n = sound_detector_process(&detector, mic_block, MIC_BLOCK_SIZE, start,
+                                       events, SOUND_MAX_EVENTS);
+        for (int i = 0; i < n; i++)
+            route_sound_event(&events[i]);
+        
+        ScopeRow row;
+        if (scope_process(&scope, scope_view, mic_block, MIC_BLOCK_SIZE,
+                          detector.clap_level, detector.noise_level, &row))
+            spsc_push(&scope_rows, &row);
+        
+        RhythmMatch beat;
+        uint32_t now = start + MIC_BLOCK_SIZE;
+        publish_rhythm(rhythm_poll(&rhythm, now, &beat), &beat, now);
+        
+        // O core1 é o único a mexer no classificador e nos códigos; o core0 só faz pedidos
+        TeachRequest teach;
+        while (spsc_pop(&teach_requests, &teach)) {
+            if (teach.codes) {
+                if (teach.request < -1)
+                    rhythm_forget(&rhythm, -2 - teach.request);
+                else
+                    rhythm_record(&rhythm, teach.request);
+                clap_held = false;
+            } else if (teach.request < -1)
+                sound_classifier_forget(&classifier, -2 - teach.request);  // -2 - classe: apaga
+            else
+                sound_classifier_record(&classifier, teach.request);
+        }
+        SoundMatch match;
+        SoundClassifierResult heard = sound_classifier_process(&classifier, mic_block, MIC_BLOCK_SIZE, &match);
+        if (heard != SOUND_CLASSIFIER_NONE) {
+            SoundEvent learned = {heard == SOUND_CLASSIFIER_MATCH ? SOUND_EVENT_LEARNED : SOUND_EVENT_RECORDED,
+                                  start + MIC_BLOCK_SIZE, match.distance, match.label};
+            spsc_push(&sound_events, &learned);
+        }
+        
+#ifdef KEYWORD_SPOTTING
+        // Custo do bloco que fecha a janela: MFCC do bloco + inferência. O
+        // SysTick tem 24 bits, então só mede até ~134 ms a 125 MHz.
+        KwsResult result;
+        uint32_t kws_start = cycle_counter_now();
+        if (kws_process(&spotter, mic_block, MIC_BLOCK_SIZE, &result)) {
+            uint32_t cost = cycle_counter_elapsed(kws_start);
+            if (cost > kws_worst_cost)
+                kws_worst_cost = cost;
+            if (result.detected) {
+                SoundEvent keyword = {SOUND_EVENT_KEYWORD, start + MIC_BLOCK_SIZE, (uint16_t)result.score, result.label};
+                spsc_push(&sound_events, &keyword);
+            }
+        }
+#endif
+    }
+    
+    core1_stopped = true;
+    while (true)
+        __wfe();
+}
 
 void init_detector() {
-    // Inicializa o microfone
-    adc_init();
-    adc_gpio_init(MIC_PIN);
-    adc_select_input(MIC_CHANNEL);  
+    dsp_dc_init(&mic_dc, OFFSET);
+    
+    SoundDetectorConfig config;
+    sound_detector_default_config(&config, MIC_SAMPLE_RATE);
+    sound_detector_init(&detector, &config);
+    spsc_init(&sound_events, sound_event_items, sizeof(SoundEvent), SOUND_QUEUE_SIZE);
+    scope_init(&scope);
+    spsc_init(&scope_rows, scope_row_items, sizeof(ScopeRow), SCOPE_QUEUE_SIZE);
+    scope_view = SCOPE_OFF;
+    spsc_init(&capture_frames, capture_items, ADPCM_FRAME_BYTES, CAPTURE_QUEUE_SIZE);
+    adpcm_init(&capture_state);
+    capture_on = false;
+    if (!classifier_ready) {
+        sound_classifier_init(&classifier);
+        spsc_init(&teach_requests, teach_items, sizeof(TeachRequest), TEACH_QUEUE_SIZE);
+        classifier_ready = true;
+    }
+    if (!rhythm_ready) {
+        rhythm_init(&rhythm, MIC_SAMPLE_RATE);
+        rhythm_ready = true;
+    }
+    rhythm_record(&rhythm, -1);
+    clap_held = false;
+#ifdef KEYWORD_SPOTTING
+    kws_placeholder_model(&kws_model);
+    kws_init(&spotter, &kws_model);
+    kws_worst_cost = 0;
+#endif
+    
+    // Inicializa o microfone e a detecção no segundo núcleo
+    core1_running = true;
+    core1_stopped = false;
+    multicore_launch_core1(detector_core1_main);
     
     // // Inicializa os LEDs
     // neopixel_init(LEDS_MATRIX);
@@ -542,94 +1157,183 @@ void init_detector() {
     // Inicializa Buzzer
     gpio_set_function(BUZZER_1, GPIO_FUNC_PWM);
     uint slice_num = pwm_gpio_to_slice_num(BUZZER_1);
-    pwm_config config = pwm_get_default_config();
-    pwm_config_set_clkdiv(&config, 4.0f);
-    pwm_init(slice_num, &config, true);
+    pwm_config pwm = pwm_get_default_config();
+    pwm_config_set_clkdiv(&pwm, 4.0f);
+    pwm_init(slice_num, &pwm, true);
     pwm_set_gpio_level(BUZZER_1, 0);
     
+    // Respostas do detector tocam por alarme de hardware, sem bloquear
+    action_player_init(BUZZER_1);
+    leds_on = false;
 }
 
-// Alterna os LEDs
+// Alterna os LEDs (a cor fica por baixo de qualquer alarme em andamento)
 void toggle_leds() {
     const uint8_t BLACK[3] = {0, 0, 0};
     const uint8_t WHITE[3] = {25, 25, 25};
     
     leds_on = !leds_on;
+    action_player_set_idle(leds_on ? WHITE : BLACK);
+}
+
+// Escreve na matriz a cor publicada pelo tocador de ações, se mudou
+void update_action_leds() {
+    uint8_t color[3];
+    
+    if (!action_player_poll(color))
+    return;
     for (int i = 0; i < NUM_LEDS; i++)
-    neopixel_set(i, leds_on ? WHITE : BLACK);
+    neopixel_set(i, color);
     neopixel_write();
-    sleep_ms(1000);
 }
 
-float get_mean_vu_value(int n) {
-    int i; uint16_t adc_value;
-    float volume_ratio, sum_volume_level;
-    sum_volume_level = 0;
-    
-    for (i = 0; i < n; i++) {
-        adc_value = adc_read();
-        volume_ratio = (float)adc_value / 4095.0;  // Normaliza entre 0 e 1
-        sum_volume_level += pow(volume_ratio, 2);
-        sleep_ms(1);
-    }
-    float mean_vu_level = sum_volume_level / (float)n;
-    return mean_vu_level;
+// Para o pipeline do core1 e devolve o núcleo ao estado de reset
+void stop_core1() {
+    core1_running = false;
+    while (!core1_stopped)
+        tight_loop_contents();
+    multicore_reset_core1();
 }
 
-// Detecta palmas
-bool detect_double_clap() {
-    float volume_level = get_mean_vu_value(5);
-    printf("DC VU Level %.2f\n", volume_level);
-    if (volume_level > CLAP_THRESHOLD && volume_level < (CLAP_THRESHOLD + 0.20)) {
-        absolute_time_t now = get_absolute_time();
-        int64_t time_diff = absolute_time_diff_us(last_clap_time, now) / 1000;
-        
-        if (time_diff > 200 && time_diff < 1000)
-        return true;
-        last_clap_time = now;
+// Próximo evento publicado pelo core1 (sem bloquear)
+bool next_sound_event(SoundEvent *event) {
+    return spsc_pop(&sound_events, event);
+}
+
+#ifdef DSP_BENCHMARK
+
+// Caminho antigo: normaliza para float e usa pow() em dupla precisão
+float get_mean_vu_value_float(const uint16_t *block, int n) {
+    float volume_ratio, sum_volume_level = 0;
+    
+    for (int i = 0; i < n; i++) {
+        volume_ratio = (float)block[i] / 4095.0;  // Normaliza entre 0 e 1
+        sum_volume_level += pow(volume_ratio, 2);
     }
-    return false;
+    return sum_volume_level / (float)n;
 }
 
-// Ativa alarme de intrusão
-void activate_alarm() {
-    const uint8_t BLACK[3] = {0, 0, 0};
-    const uint8_t RED[3] = {25, 0, 0};
+// Mede ciclos por amostra do caminho em float contra os kernels em ponto fixo
+void benchmark_vu_path() {
+    const int runs = 16;
+    Envelope env;
+    uint32_t start, cycles_float = 0, cycles_dc = 0, cycles_sum = 0, cycles_peak = 0, cycles_env = 0;
+    volatile float sink_float;
+    volatile uint32_t sink;
     
-    for (int i = 0; i < 15; i++) {
-        for (int j = 0; j < NUM_LEDS; j++)
-        neopixel_set(j, RED);
-        neopixel_write();
-        pwm_set_gpio_level(BUZZER_1, 5000);
+    dsp_envelope_init(&env, 2, 8);
+    for (int r = 0; r < runs; r++) {
+        const uint16_t *block = adc_service_wait_block();
         
-        sleep_ms(200);
+        start = cycle_counter_now();
+        sink_float = get_mean_vu_value_float(block, MIC_BLOCK_SIZE);
+        cycles_float += cycle_counter_elapsed(start);
         
-        pwm_set_gpio_level(BUZZER_1, 0);
-        for (int j = 0; j < NUM_LEDS; j++)
-        neopixel_set(j, BLACK);
-        neopixel_write();
+        start = cycle_counter_now();
+        dsp_dc_remove(&mic_dc, block, mic_block, MIC_BLOCK_SIZE);
+        cycles_dc += cycle_counter_elapsed(start);
         
-        sleep_ms(200);
+        start = cycle_counter_now();
+        sink = dsp_rms(dsp_sum_squares(mic_block, MIC_BLOCK_SIZE), MIC_BLOCK_SIZE);
+        cycles_sum += cycle_counter_elapsed(start);
+        
+        start = cycle_counter_now();
+        sink = dsp_peak(mic_block, MIC_BLOCK_SIZE);
+        cycles_peak += cycle_counter_elapsed(start);
+        
+        start = cycle_counter_now();
+        sink = dsp_envelope(&env, mic_block, MIC_BLOCK_SIZE);
+        cycles_env += cycle_counter_elapsed(start);
     }
+    (void)sink_float; (void)sink;
+    
+    const int samples = runs * MIC_BLOCK_SIZE;
+    printf("VU float/pow: %lu %s/amostra\n", cycles_float / samples, CYCLE_COUNTER_UNIT);
+    printf("DC remove:    %lu %s/amostra\n", cycles_dc / samples, CYCLE_COUNTER_UNIT);
+    printf("Sum sq + RMS: %lu %s/amostra\n", cycles_sum / samples, CYCLE_COUNTER_UNIT);
+    printf("Peak:         %lu %s/amostra\n", cycles_peak / samples, CYCLE_COUNTER_UNIT);
+    printf("Envelope:     %lu %s/amostra\n", cycles_env / samples, CYCLE_COUNTER_UNIT);
+    
+    // Custo por janela dos kernels espectrais
+    static int16_t window[SPECTRUM_FFT_SIZE] __attribute__((aligned(4)));
+    const uint16_t tones[] = {520, 1000, 2000, 3100};
+    uint16_t tone_power[4];
+    GoertzelBank bank;
+    SpectralFeatures features;
     
+    for (int i = 0; i < SPECTRUM_FFT_SIZE; i += MIC_BLOCK_SIZE)
+        dsp_dc_remove(&mic_dc, adc_service_wait_block(), window + i, MIC_BLOCK_SIZE);
+    goertzel_bank_init(&bank, tones, 4, MIC_SAMPLE_RATE);
+    spectrum_analyze(window, MIC_SAMPLE_RATE, &features);
+    goertzel_bank_process(&bank, window, SPECTRUM_FFT_SIZE, tone_power);
+    
+    const SpectrumStats *stats = spectrum_stats();
+    printf("Janela Hann:  %lu %s/bloco\n", stats->window, CYCLE_COUNTER_UNIT);
+    printf("FFT 256:      %lu %s/bloco\n", stats->fft, CYCLE_COUNTER_UNIT);
+    printf("Potencia:     %lu %s/bloco\n", stats->power, CYCLE_COUNTER_UNIT);
+    printf("Features:     %lu %s/bloco\n", stats->features, CYCLE_COUNTER_UNIT);
+    printf("Goertzel x4:  %lu %s/bloco\n", stats->goertzel, CYCLE_COUNTER_UNIT);
+    
+    // Busca do classificador ensinado com o índice cheio; as distâncias
+    // caem a cada exemplo, então o corte antecipado nunca acontece
+    static SoundIndex index;
+    SoundVector query = {{0}};
+    uint16_t distance;
+    for (int i = 0; i < SOUND_INDEX_SIZE; i++) {
+        for (int b = 0; b < SOUND_FEATURE_DIMS; b++)
+            index.examples[i].v[b] = (int8_t)(SOUND_INDEX_SIZE - i);
+        index.labels[i] = i / SOUND_EXAMPLES;
+    }
+    index.count = SOUND_INDEX_SIZE;
+    start = cycle_counter_now();
+    sink = sound_index_nearest(&index, &query, &distance);
+    printf("Busca %d ex.: %lu %s\n", SOUND_INDEX_SIZE, cycle_counter_elapsed(start), CYCLE_COUNTER_UNIT);
+    
+    // Uma inferência completa da DS-CNN (entrada sem zeros, pior caso). O
+    // custo não depende dos valores dos pesos, então os de teste bastam.
+    static KwsModel bench_model;
+    static int8_t kws_input[KWS_FRAMES][MFCC_COEFFS];
+    int8_t logits[KWS_LABELS];
+    for (int i = 0; i < KWS_FRAMES * MFCC_COEFFS; i++)
+        kws_input[i / MFCC_COEFFS][i % MFCC_COEFFS] = (int8_t)(i * 37 % 61 - 30) | 1;
+    kws_placeholder_model(&bench_model);
+    kws_infer(&bench_model, kws_input, logits);
+    
+    const KwsStats *kws = kws_stats();
+    const MfccStats *mfcc = mfcc_stats();
+    printf("MFCC quadro:  %lu %s\n", mfcc->spectrum + mfcc->mel + mfcc->dct, CYCLE_COUNTER_UNIT);
+    printf("DS-CNN conv:  %lu %s\n", kws->conv, CYCLE_COUNTER_UNIT);
+    printf("DS-CNN blocos: %lu %s\n", kws->blocks, CYCLE_COUNTER_UNIT);
+    printf("DS-CNN total: %lu %s (%lu MACs)\n", kws->total, CYCLE_COUNTER_UNIT, kws_macs());
 }
+#endif
 
-// Detecta som alto
-bool detect_loud_noise() {
-    float volume_level = get_mean_vu_value(30);
-    printf("Noise VU Level %.2f\n", volume_level);
-    if (volume_level > NOISE_THRESHOLD) {
-        // absolute_time_t now = get_absolute_time();
-        // int64_t time_diff = absolute_time_diff_us(last_noise_time, now) / 1000;
-        
-        // if (time_diff > 300 && time_diff < 1000)
-        return true;
-        // last_noise_time = now;
-    }
-    return false;
+// Alarme de intrusão: vermelho com bipe e apagado, 200 ms cada
+static const ActionStep alarm_steps[] = {
+    {200, 5000, {25, 0, 0}},
+    {200, 0, {0, 0, 0}},
+};
+static const ActionPattern alarm_pattern = {alarm_steps, 2};
+
+#define ALARM_REPEATS 15
+
+// Ativa alarme de intrusão; um novo som alto durante o alarme o prolonga
+void activate_alarm() {
+    action_player_trigger(&alarm_pattern, ALARM_REPEATS, ACTION_EXTEND);
 }
 
+// Som ensinado reconhecido: três piscadas azuis com bipe curto
+static const ActionStep learned_steps[] = {
+    {120, 3000, {0, 0, 25}},
+    {120, 0, {0, 0, 0}},
+};
+static const ActionPattern learned_pattern = {learned_steps, 2};
 
+// Responde a um som ensinado, sem interromper o alarme
+void activate_learned() {
+    if (action_player_pattern() != &alarm_pattern)
+    action_player_trigger(&learned_pattern, 3, ACTION_RESTART);
+}
 
 // Exibe o menu
 void display_noise_menu() {
@@ -637,41 +1341,658 @@ void display_noise_menu() {
     ssd1306_draw_string(display.buffer, 10, 10, "NOISE DETECTOR");
     ssd1306_draw_string(display.buffer, 5, 30, "A: Listen/Stop");
     ssd1306_draw_string(display.buffer, 5, 40, "B: Exit");
+    ssd1306_draw_string(display.buffer, 5, 48, "Up/Down: Teach");
+    ssd1306_draw_string(display.buffer, 5, 56, "Side: Scope");
+    render_on_display(display.buffer, &display.frame_area);
+}
+
+// Troca a visualização do microfone (SCOPE_OFF volta ao menu)
+void show_scope_view(ScopeView view) {
+    ScopeRow row;
+    
+    scope_view = view;
+    while (spsc_pop(&scope_rows, &row))
+        ;  // Descarta as linhas da visualização anterior
+    scope_line = 0;
+    ssd1306_set_start_line(0);
+    if (view == SCOPE_OFF) {
+        display_noise_menu();
+        return;
+    }
+    memset(display.buffer, 0, ssd1306_buffer_length);
+    render_on_display(display.buffer, &display.frame_area);
+}
+
+// Desenha as linhas novas da visualização e rola a tela pela linha inicial
+// do SSD1306: só as páginas alteradas são enviadas (~3 ms cada), uma por
+// linha de 16 ms, e a imagem antiga sobe sem ser reenviada
+void update_scope() {
+    ScopeRow row;
+    uint8_t dirty = 0;  // Páginas alteradas, um bit por página
+    
+    while (spsc_pop(&scope_rows, &row)) {
+        ssd1306_draw_shaded_row(display.buffer, scope_line, row.shade);
+        dirty |= 1 << (scope_line / ssd1306_page_height);
+        scope_line = (scope_line + 1) % ssd1306_height;
+    }
+    if (!dirty)
+        return;
+    
+    for (int page = 0; page < ssd1306_n_pages; page++)
+        if (dirty & (1 << page))
+            ssd1306_render_pages(display.buffer, page, page);
+    // A linha mais nova fica embaixo: o topo mostra a próxima a ser escrita
+    ssd1306_set_start_line(scope_line);
+}
+
+// Escreve a linha de status do menu do detector
+void show_status(const char *text) {
+    memset(display.buffer + ssd1306_width * 2, 0, ssd1306_width);  // Página da linha y = 20
+    ssd1306_draw_string(display.buffer, 5, 20, (char *)text);
+    render_on_display(display.buffer, &display.frame_area);
+}
+
+// Mostra na linha de status o último som ensinado ou código reconhecido
+void show_heard(const char *kind, uint8_t label) {
+    char text[17];
+    
+    snprintf(text, sizeof(text), "Heard: %s %u", kind, label + 1);
+    show_status(text);
+}
+
+// Atende os comandos do host na USB ('c' inicia a captura, 's' para) e envia
+// os quadros prontos. O envio usa o driver USB direto, sem a conversão de
+// \n em \r\n do printf; textos do printf entre quadros são descartados pelo
+// receptor, que se ressincroniza pelo marcador e pelo CRC. Retorna true se
+// a captura ligou ou desligou.
+bool update_capture() {
+    int command = getchar_timeout_us(0);
+    bool connected = stdio_usb_connected();
+    bool was_on = capture_on;
+    
+    if (command == 'c' && connected)
+        capture_on = true;
+    else if (command == 's' || !connected)
+        capture_on = false;
+    
+    uint8_t frame[ADPCM_FRAME_BYTES];
+    while (spsc_pop(&capture_frames, frame))
+        if (connected)
+            stdio_usb.out_chars((const char *)frame, ADPCM_FRAME_BYTES);
+    return capture_on != was_on;
+}
+
+// Direção do joystick: -1, 0 ou 1 em cada eixo (y positivo para cima)
+void joystick_direction(int *dx, int *dy) {
+    const int threshold = 1500;
+    int x = adc_service_value(X_CHANNEL) - 2048;
+    int y = adc_service_value(Y_CHANNEL) - 2048;
+    
+    *dx = x > threshold ? 1 : x < -threshold ? -1 : 0;
+    *dy = y > threshold ? 1 : y < -threshold ? -1 : 0;
+}
+
+#define TEACH_SLOTS 4   // Classes de som e códigos rítmicos por página
+
+// Tela do modo de ensino: classes com o número de exemplos gravados (página
+// 0) ou códigos com o número de batidas (página 1) e uma linha de status
+void display_teach_menu(int page, int slot, const char *status) {
+    char line[17];
+    
+    memset(display.buffer, 0, ssd1306_buffer_length);
+    ssd1306_draw_string(display.buffer, 10, 0, page ? "TEACH CODES" : "TEACH SOUNDS");
+    for (int i = 0; i < TEACH_SLOTS; i++) {
+        uint8_t stored = classifier.index.stored[i];
+        if (page)
+        snprintf(line, sizeof(line), "%c Code %d: %d", i == slot ? 'x' : ' ', i + 1, rhythm.patterns[i].onsets);
+        else
+        snprintf(line, sizeof(line), "%c Sound %d: %d", i == slot ? 'x' : ' ', i + 1,
+                 stored < SOUND_EXAMPLES ? stored : SOUND_EXAMPLES);
+        ssd1306_draw_string(display.buffer, 0, 16 + i * 8, line);
+    }
+    ssd1306_draw_string(display.buffer, 0, 56, (char *)status);
+    render_on_display(display.buffer, &display.frame_area);
+}
+
+// Pede ao core1 (dono do índice de sons e dos códigos) para gravar no slot
+// (request >= 0), cancelar (-1) ou apagar (-2 - slot)
+void request_teach(int page, int8_t request) {
+    TeachRequest teach = {page != 0, request};
+    
+    spsc_push(&teach_requests, &teach);
+}
+
+// Modo de ensino: o joystick escolhe a classe, A grava o próximo som (ou
+// a próxima sequência de batidas) como exemplo ou cancela a gravação, puxar
+// o joystick para a esquerda apaga, para a direita troca entre sons e
+// códigos, e B volta ao detector. A detecção continua no core1.
+void teach_mode() {
+    int page = 0;
+    int slot = 0;
+    bool recording = false;
+    
+    display_teach_menu(page, slot, "A: Rec  B: Back");
+    sleep_ms(300);
+    while (true) {
+        SoundEvent event;
+        while (next_sound_event(&event)) {
+            if (event.type == SOUND_EVENT_RECORDED || event.type == SOUND_EVENT_RHYTHM_RECORDED) {
+                recording = false;
+                display_teach_menu(page, slot, "Saved!");
+            }
+            else if (event.type == SOUND_EVENT_LEARNED || event.type == SOUND_EVENT_RHYTHM) {
+                bool same = page == (event.type == SOUND_EVENT_RHYTHM) && event.sound_class == slot;
+                activate_learned();
+                display_teach_menu(page, slot, same ? "Heard: this one" : "Heard: other");
+            }
+            else if (event.type == SOUND_EVENT_LOUD_NOISE && !recording)
+            activate_alarm();
+        }
+        update_action_leds();
+        update_capture();
+        
+        int dx, dy;
+        joystick_direction(&dx, &dy);
+        if (dy != 0 && !recording) {
+            slot = (slot - dy + TEACH_SLOTS) % TEACH_SLOTS;
+            display_teach_menu(page, slot, "A: Rec  B: Back");
+            sleep_ms(250);
+        }
+        else if (dx > 0 && !recording) {
+            page = !page;
+            display_teach_menu(page, slot, "A: Rec  B: Back");
+            sleep_ms(300);
+        }
+        else if (dx < 0 && !recording) {
+            request_teach(page, -2 - slot);
+            display_teach_menu(page, slot, "Cleared");
+            sleep_ms(300);
+        }
+        else if (!gpio_get(BUTTON_A)) {
+            recording = !recording;
+            request_teach(page, recording ? slot : -1);
+            display_teach_menu(page, slot, !recording ? "Cancelled" : page ? "Knock the code" : "Make the sound");
+            sleep_ms(300);
+        }
+        else if (!gpio_get(BUTTON_B)) {
+            request_teach(page, -1);
+            sleep_ms(300);
+            return;
+        }
+        sleep_ms(1);
+    }
+}
+
+// Sai do detector de volta ao menu
+void exit_detector() {
+    action_player_cancel();
+    stop_core1();
+    capture_on = false;
+    scope_view = SCOPE_OFF;
+    ssd1306_set_start_line(0);
+    memset(display.buffer, 0, ssd1306_buffer_length);
     render_on_display(display.buffer, &display.frame_area);
+    clear_all();
+}
+
+// Ação de cada código rítmico, na ordem dos slots do modo de ensino (e das
+// palavras da DS-CNN, a partir de KWS_LIGHTS)
+typedef enum {
+    COMMAND_LIGHTS,
+    COMMAND_STOP,
+    COMMAND_MUSIC,
+    COMMAND_GAME
+} Command;
+
+// Executa o comando (de código rítmico ou de voz); retorna o modo a abrir em
+// seguida (-1: nenhum)
+int handle_command(uint8_t command) {
+    switch (command) {
+        case COMMAND_LIGHTS:
+            toggle_leds();
+            break;
+        case COMMAND_STOP:
+            action_player_cancel();
+            break;
+        case COMMAND_GAME:
+            return 0;
+        case COMMAND_MUSIC:
+            return 1;
+    }
+    return -1;
 }
 
-// Loop principal de detecção
+#ifdef KEYWORD_SPOTTING
+// Imprime via USB, a cada segundo, o pior custo de um bloco com inferência
+// (a medida no RP2040 que falta para o README). Calado durante a captura,
+// que usa a mesma porta.
+void report_kws_cost() {
+    static uint32_t last_report = 0;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if (capture_on || now - last_report < 1000)
+        return;
+    last_report = now;
+    printf("KWS pior janela: %lu %s\n", kws_worst_cost, CYCLE_COUNTER_UNIT);
+}
+#endif
 
-void detect_loop() {
+// Loop principal de detecção; retorna o modo pedido por código ou voz (-1: menu)
+
+int detect_loop() {
     display_noise_menu();
     listening = true;
     while (true) {
-            if (listening) {
-                if (detect_loud_noise())
+            SoundEvent event;
+            while (next_sound_event(&event)) {
+                if (!listening)
+                continue;  // Pausado: descarta os eventos
+                if (event.type == SOUND_EVENT_LOUD_NOISE)
                 activate_alarm();
-                else if (detect_double_clap())
+                else if (event.type == SOUND_EVENT_DOUBLE_CLAP)
                 toggle_leds();
+                else if (event.type == SOUND_EVENT_LEARNED) {
+                    activate_learned();
+                    if (scope_view == SCOPE_OFF)
+                    show_heard("Sound", event.sound_class);
+                }
+                else if (event.type == SOUND_EVENT_RHYTHM || event.type == SOUND_EVENT_KEYWORD) {
+                    bool code = event.type == SOUND_EVENT_RHYTHM;
+                    if (code && scope_view == SCOPE_OFF)
+                    show_heard("Code", event.sound_class);
+                    if (!code && !capture_on)
+                    printf("Comando: %s\n", kws_label_name(event.sound_class));
+                    int mode = handle_command(code ? event.sound_class : event.sound_class - KWS_LIGHTS);
+                    if (mode >= 0) {
+                        exit_detector();
+                        return mode;
+                    }
+                }
+            }
+            update_action_leds();
+            if (update_capture() && scope_view == SCOPE_OFF)
+            show_status(capture_on ? "USB: Capturing" : "USB: Stopped");
+            if (scope_view != SCOPE_OFF)
+            update_scope();
+#ifdef KEYWORD_SPOTTING
+            report_kws_cost();
+#endif
+            
+            int dx, dy;
+            joystick_direction(&dx, &dy);
+            if (dy != 0) {
+                show_scope_view(SCOPE_OFF);
+                teach_mode();
+                display_noise_menu();
             }
-            if (!gpio_get(BUTTON_A)) {
+            else if (dx != 0) {
+                show_scope_view((scope_view + 1) % 3);  // Menu -> espectrograma -> nível
                 sleep_ms(300);
+            }
+            else if (!gpio_get(BUTTON_A)) {
+                if (action_player_active())
+                action_player_cancel();  // Silencia o alarme
+                else
                 listening = !listening;  // Alterna entre ouvir e pausar
+                sleep_ms(300);
             }
             else if (!gpio_get(BUTTON_B)) {
                 sleep_ms(300);
-                memset(display.buffer, 0, ssd1306_buffer_length);
-                render_on_display(display.buffer, &display.frame_area);
-                clear_all();
-                break;  // Sai do loop
+                exit_detector();
+                return -1;  // Sai do loop
             }
-            sleep_ms(10);
+            sleep_ms(1);
         }
 }
 
 // Função principal
 int detect_sounds() {
     init_detector();
-    detect_loop();
-    return 0;
+    return detect_loop();
+}
+
+// ----------------------------------------------
+// ----------------------------------------------
+// -------------- LUZES NO RITMO ----------------
+// ----------------------------------------------
+// ----------------------------------------------
+
+#define LIGHT_QUEUE_SIZE 8  // Quadros de análise em trânsito do core1 para o core0
+#define BEAT_PULSE 12       // Brilho do fundo na batida (cai 3 por quadro, ~32 ms)
+
+typedef struct {
+    BeatFrame frame;
+    uint32_t block_us;      // Chegada do último bloco analisado, para medir a latência
+    uint32_t cost;          // Ciclos da análise no core1
+} LightFrame;
+
+BeatTracker beats;
+LightFrame light_frame_items[LIGHT_QUEUE_SIZE];
+SpscQueue light_frames;
+
+// Análise no core1: a cada 8 ms uma FFT dá as colunas e a batida. O core0
+// só acende os LEDs, então a tela não atrasa as luzes.
+void lights_core1_main() {
+    cycle_counter_init();
+    adc_service_flush();
+    
+    while (core1_running) {
+        const uint16_t *block = adc_service_wait_block();
+        uint32_t arrived = time_us_32();
+        LightFrame light;
+        
+        dsp_dc_remove(&mic_dc, block, mic_block, MIC_BLOCK_SIZE);
+        if (beat_tracker_process(&beats, mic_block, MIC_BLOCK_SIZE, &light.frame)) {
+            light.block_us = arrived;
+            light.cost = beats.cost;
+            spsc_push(&light_frames, &light);
+        }
+    }
+    
+    core1_stopped = true;
+    while (true)
+        __wfe();
+}
+
+// Colunas com as cores do reprodutor de música (graves à esquerda); na
+// batida os LEDs apagados acendem em branco fraco
+void light_beat_leds(const BeatFrame *frame, uint8_t pulse) {
+    const uint8_t *palette[BEAT_LEVELS] = {BLUE, MAGENTA, MAGENTA, RED, RED};
+    const uint8_t glow[3] = {pulse, pulse, pulse};
+    
+    for (int column = 0; column < BEAT_BANDS; column++)
+        for (int i = 0; i < BEAT_LEVELS; i++)
+            neopixel_set(index_[column][i], i < frame->levels[column] ? palette[i] : glow);
+    neopixel_write();
+}
+
+void display_lights_menu() {
+    memset(display.buffer, 0, ssd1306_buffer_length);
+    ssd1306_draw_string(display.buffer, 10, 10, "MUSIC LIGHTS");
+    ssd1306_draw_string(display.buffer, 5, 50, "B: Exit");
+    render_on_display(display.buffer, &display.frame_area);
+}
+
+// Andamento, pior latência (bloco do ADC até os LEDs) e pior custo da
+// análise no core1 do último segundo. Só as páginas das linhas são
+// enviadas: a tela inteira levaria ~25 ms no I2C.
+void show_lights_status(uint16_t bpm, uint32_t lag_us, uint32_t cost) {
+    char line[17];
+    
+    memset(display.buffer + 3 * ssd1306_width, 0, 3 * ssd1306_width);
+    if (bpm)
+        snprintf(line, sizeof(line), "BPM %u", bpm);
+    else
+        snprintf(line, sizeof(line), "BPM --");
+    ssd1306_draw_string(display.buffer, 5, 24, line);
+    snprintf(line, sizeof(line), "Lag %lu ms", (unsigned long)(lag_us + 999) / 1000);
+    ssd1306_draw_string(display.buffer, 5, 32, line);
+    snprintf(line, sizeof(line), "Core1 %lu us", (unsigned long)((uint64_t)cost * 1000000 / clock_get_hz(clk_sys)));
+    ssd1306_draw_string(display.buffer, 5, 40, line);
+    ssd1306_render_pages(display.buffer, 3, 5);
+}
+
+// Modo de luzes: a matriz acompanha a música ambiente até B ser pressionado
+void music_lights() {
+    dsp_dc_init(&mic_dc, OFFSET);
+    beat_tracker_init(&beats, MIC_SAMPLE_RATE);
+    spsc_init(&light_frames, light_frame_items, sizeof(LightFrame), LIGHT_QUEUE_SIZE);
+    core1_running = true;
+    core1_stopped = false;
+    multicore_launch_core1(lights_core1_main);
+    
+    display_lights_menu();
+    uint8_t pulse = 0;
+    uint16_t bpm = 0;
+    uint32_t worst_lag = 0, worst_cost = 0;
+    absolute_time_t next_status = make_timeout_time_ms(1000);
+    while (true) {
+        LightFrame light;
+        bool fresh = false;
+        
+        // Só o quadro mais novo é desenhado; as batidas dos anteriores não se perdem
+        while (spsc_pop(&light_frames, &light)) {
+            pulse = light.frame.beat ? BEAT_PULSE : pulse > 3 ? pulse - 3 : 0;
+            if (light.cost > worst_cost)
+                worst_cost = light.cost;
+            fresh = true;
+        }
+        if (fresh) {
+            light_beat_leds(&light.frame, pulse);
+            uint32_t lag = time_us_32() - light.block_us;
+            if (lag > worst_lag)
+                worst_lag = lag;
+            bpm = light.frame.bpm;
+        }
+        
+        if (time_reached(next_status)) {
+            show_lights_status(bpm, worst_lag, worst_cost);
+            worst_lag = 0;
+            worst_cost = 0;
+            next_status = make_timeout_time_ms(1000);
+        }
+        if (!gpio_get(BUTTON_B)) {
+            sleep_ms(300);
+            stop_core1();
+            memset(display.buffer, 0, ssd1306_buffer_length);
+            render_on_display(display.buffer, &display.frame_area);
+            clear_all();
+            return;
+        }
+        sleep_ms(1);
+    }
+}
+
+// ----------------------------------------------
+// ----------------------------------------------
+// ------------ RECADO DE VOZ (INTERCOM) --------
+// ----------------------------------------------
+// ----------------------------------------------
+
+#define CLIP_QUEUE_SIZE 8   // Páginas em trânsito do core1 para o core0 (~0,5 s)
+#define CLIP_LEVEL 24000    // Pico do recado depois do ganho da reprodução
+
+// Gravação: o core1 reduz para 8 kHz e codifica; o core0 grava as páginas
+uint8_t clip_page_items[CLIP_QUEUE_SIZE][FLASH_PAGE_SIZE];
+SpscQueue clip_pages;
+uint8_t clip_page[FLASH_PAGE_SIZE];   // Página em montagem (core1)
+uint16_t clip_page_fill;
+volatile uint16_t clip_peak;
+AdpcmState clip_state;
+
+// Reprodução: a interrupção do DMA decodifica direto da flash
+uint32_t play_pos;
+AdpcmState play_state;
+int32_t play_gain;                    // Q8
+
+void intercom_core1_main() {
+    int16_t half[MIC_BLOCK_SIZE / 2];
+    
+    multicore_lockout_victim_init();  // O core0 pausa este núcleo ao gravar a flash
+    adc_service_flush();
+    while (core1_running) {
+        const uint16_t *block = adc_service_wait_block();
+        
+        // 16 kHz -> 8 kHz pela média de pares, na escala de 16 bits da captura USB
+        dsp_dc_remove(&mic_dc, block, mic_block, MIC_BLOCK_SIZE);
+        uint16_t peak = clip_peak;
+        for (int i = 0; i < MIC_BLOCK_SIZE / 2; i++) {
+            int32_t v = (mic_block[2 * i] + mic_block[2 * i + 1]) * 8;
+            half[i] = v > 32767 ? 32767 : v < -32768 ? -32768 : v;
+            uint16_t a = v < 0 ? -v : v;
+            if (a > peak)
+                peak = a;
+        }
+        clip_peak = peak;
+        
+        adpcm_encode(&clip_state, half, clip_page + clip_page_fill, MIC_BLOCK_SIZE / 2);
+        clip_page_fill += MIC_BLOCK_SIZE / 4;
+        if (clip_page_fill == FLASH_PAGE_SIZE) {
+            spsc_push(&clip_pages, clip_page);
+            clip_page_fill = 0;
+        }
+    }
+    
+    core1_stopped = true;
+    while (true)
+        __wfe();
+}
+
+// Preenche o próximo bloco da reprodução (na interrupção do DMA)
+int play_clip_block(int16_t *samples, int n) {
+    const VoiceClipHeader *header = voice_clip_header();
+    uint32_t left = header->samples - play_pos;
+    
+    if ((uint32_t)n > left)
+        n = left & ~1u;
+    adpcm_decode(&play_state, voice_clip_data() + play_pos / 2, samples, n);
+    for (int i = 0; i < n; i++) {
+        int32_t v = (samples[i] * play_gain) >> 8;
+        samples[i] = v > 32767 ? 32767 : v < -32768 ? -32768 : v;
+    }
+    play_pos += n;
+    return n;
+}
+
+void display_intercom_menu(const char *status) {
+    memset(display.buffer, 0, ssd1306_buffer_length);
+    ssd1306_draw_string(display.buffer, 10, 10, "INTERCOM");
+    ssd1306_draw_string(display.buffer, 5, 20, (char *)status);
+    ssd1306_draw_string(display.buffer, 5, 35, "A: Rec/Stop");
+    ssd1306_draw_string(display.buffer, 5, 45, "Up: Play/Stop");
+    ssd1306_draw_string(display.buffer, 5, 55, "B: Exit");
+    render_on_display(display.buffer, &display.frame_area);
+}
+
+// Duração do recado gravado, para a linha de status
+void show_clip_status() {
+    const VoiceClipHeader *header = voice_clip_header();
+    char text[17];
+    
+    if (header)
+        snprintf(text, sizeof(text), "Clip: %lu.%lu s", (unsigned long)(header->samples / CLIP_SAMPLE_RATE),
+                 (unsigned long)(header->samples % CLIP_SAMPLE_RATE * 10 / CLIP_SAMPLE_RATE));
+    else
+        snprintf(text, sizeof(text), "No clip");
+    display_intercom_menu(text);
+}
+
+// Apaga a região e começa a gravar no core1
+void start_recording(VoiceClipWriter *writer) {
+    display_intercom_menu("Erasing...");
+    
+    // O serviço do ADC rearma o DMA por interrupção a cada 4 ms: fica parado
+    // enquanto cada setor é apagado com as interrupções desligadas
+    adc_service_stop();
+    voice_clip_erase(writer, false);
+    adc_service_start();
+    writer->lockout = true;
+    
+    dsp_dc_init(&mic_dc, OFFSET);
+    adpcm_init(&clip_state);
+    clip_page_fill = 0;
+    clip_peak = 1;
+    spsc_init(&clip_pages, clip_page_items, FLASH_PAGE_SIZE, CLIP_QUEUE_SIZE);
+    core1_running = true;
+    core1_stopped = false;
+    multicore_launch_core1(intercom_core1_main);
+    display_intercom_menu("Recording...");
+}
+
+// Grava as páginas prontas; false se a região encheu
+bool save_clip_pages(VoiceClipWriter *writer) {
+    uint8_t page[FLASH_PAGE_SIZE];
+    
+    while (spsc_pop(&clip_pages, page))
+        if (!voice_clip_append(writer, page))
+            return false;
+    return true;
+}
+
+// Para o core1, grava o resto do áudio e o cabeçalho
+void stop_recording(VoiceClipWriter *writer) {
+    stop_core1();
+    writer->lockout = false;
+    save_clip_pages(writer);
+    
+    uint32_t samples = writer->pages * FLASH_PAGE_SIZE * 2;
+    if (clip_page_fill > 0) {
+        memset(clip_page + clip_page_fill, 0, FLASH_PAGE_SIZE - clip_page_fill);
+        if (voice_clip_append(writer, clip_page))
+            samples += clip_page_fill * 2;
+    }
+    voice_clip_finish(writer, samples, clip_peak);
+}
+
+void start_playback() {
+    const VoiceClipHeader *header = voice_clip_header();
+    
+    if (!header)
+        return;
+    play_pos = 0;
+    adpcm_init(&play_state);
+    play_gain = (CLIP_LEVEL << 8) / header->peak;
+    if (play_gain > 64 << 8)
+        play_gain = 64 << 8;  // Recado quase mudo: não amplifica só o ruído
+    pwm_audio_start(BUZZER_1, header->sample_rate, play_clip_block);
+    display_intercom_menu("Playing...");
+}
+
+// Grava um recado curto pelo microfone e o reproduz no buzzer. A: grava ou
+// para, joystick para cima/baixo: toca ou para, B: volta ao menu.
+void intercom() {
+    VoiceClipWriter writer;
+    bool recording = false;
+    bool playing = false;
+    
+    show_clip_status();
+    sleep_ms(300);
+    while (true) {
+        if (recording && !save_clip_pages(&writer)) {
+            stop_recording(&writer);  // Região cheia
+            recording = false;
+            show_clip_status();
+        }
+        if (playing && !pwm_audio_active()) {
+            playing = false;
+            show_clip_status();
+        }
+        
+        int dx, dy;
+        joystick_direction(&dx, &dy);
+        if (!gpio_get(BUTTON_A)) {
+            if (recording)
+                stop_recording(&writer);
+            else {
+                pwm_audio_stop();
+                playing = false;
+                start_recording(&writer);
+            }
+            recording = !recording;
+            if (!recording)
+                show_clip_status();
+            sleep_ms(300);
+        }
+        else if (dy != 0 && !recording) {
+            if (playing)
+                pwm_audio_stop();
+            else
+                start_playback();
+            playing = pwm_audio_active();
+            if (!playing)
+                show_clip_status();
+            sleep_ms(300);
+        }
+        else if (!gpio_get(BUTTON_B)) {
+            if (recording)
+                stop_recording(&writer);
+            pwm_audio_stop();
+            sleep_ms(300);
+            memset(display.buffer, 0, ssd1306_buffer_length);
+            render_on_display(display.buffer, &display.frame_area);
+            return;
+        }
+        sleep_ms(1);
+    }
 }
 
 // ----------------------------------------------
@@ -709,6 +2030,10 @@ void init() {
     gpio_pull_up(BUTTON_A);
     gpio_pull_up(BUTTON_B);
     
+    // ADC compartilhado: joystick e microfone em round-robin, 16 kHz por canal
+    adc_service_init((1 << Y_CHANNEL) | (1 << X_CHANNEL) | (1 << MIC_CHANNEL),
+                     MIC_CHANNEL, MIC_SAMPLE_RATE);
+    adc_service_start();
 }
 
 void light_home_leds() {
@@ -735,10 +2060,12 @@ void light_home_leds() {
 void show_menu(int option) {
     printf("Menu is on!\n");
     memset(display.buffer, 0, ssd1306_buffer_length);
-    ssd1306_draw_string(display.buffer, 20, 10, "SELECT MODE:");
-    ssd1306_draw_string(display.buffer, 0, 25, option == 0 ? "x Snake Game" : "  Snake Game");
-    ssd1306_draw_string(display.buffer, 0, 35, option == 1 ? "x Music Player" : "  Music Player");
-    ssd1306_draw_string(display.buffer, 0, 45, option == 2 ? "x Noise Detect" : "  Noise Detect");
+    ssd1306_draw_string(display.buffer, 20, 2, "SELECT MODE:");
+    ssd1306_draw_string(display.buffer, 0, 16, option == 0 ? "x Snake Game" : "  Snake Game");
+    ssd1306_draw_string(display.buffer, 0, 26, option == 1 ? "x Music Player" : "  Music Player");
+    ssd1306_draw_string(display.buffer, 0, 36, option == 2 ? "x Noise Detect" : "  Noise Detect");
+    ssd1306_draw_string(display.buffer, 0, 46, option == 3 ? "x Music Lights" : "  Music Lights");
+    ssd1306_draw_string(display.buffer, 0, 56, option == 4 ? "x Intercom" : "  Intercom");
     render_on_display(display.buffer, &display.frame_area);
 }
 
@@ -752,22 +2079,35 @@ int main() {
     while (true) {
         if (!gpio_get(BUTTON_A)) {  // Alterna entre opções
             sleep_ms(300);
-            option = (option + 1) % 3;
+            option = (option + 1) % 5;
             show_menu(option);
         }
         else if (!gpio_get(BUTTON_B)) {  // Confirma seleção
             clear_all();
             sleep_ms(300);
-            switch (option) {
-                case 0: 
-                    run_emulator(); 
-                    break;
-                case 1: 
-                    play_songs(); 
-                    break;
-                case 2: 
-                    detect_sounds(); 
-                    break;
+            // O detector pode pedir outro modo por um código rítmico (ou por voz,
+            // com KEYWORD_SPOTTING)
+            int next = option;
+            while (next >= 0) {
+                option = next;
+                next = -1;
+                switch (option) {
+                    case 0: 
+                        run_emulator(); 
+                        break;
+                    case 1: 
+                        play_songs(); 
+                        break;
+                    case 2: 
+                        next = detect_sounds(); 
+                        break;
+                    case 3:
+                        music_lights();
+                        break;
+                    case 4:
+                        intercom();
+                        break;
+                }
             }
             show_menu(option);
             light_home_leds();
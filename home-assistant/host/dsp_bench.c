@@ -0,0 +1,76 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "audio_config.h"
+#include "audio_dsp.h"
+#include "cycle_counter.h"
+
+// Custo por amostra do caminho antigo do VU (float e pow() em dupla
+// precisão) contra os kernels em ponto fixo de libs/audio_dsp.c, sobre
+// blocos de MIC_BLOCK_SIZE amostras de ruído em torno de OFFSET. É a mesma
+// comparação que o firmware imprime com -DDSP_BENCHMARK=ON, mas em ns no
+// host: serve para conferir os kernels, não para prever os ciclos do
+// Cortex-M0+, que não tem FPU.
+
+#define BLOCKS 20000
+
+// Caminho antigo, como estava no home.c
+static float get_mean_vu_value_float(const uint16_t *block, int n) {
+    float volume_ratio, sum_volume_level = 0;
+
+    for (int i = 0; i < n; i++) {
+        volume_ratio = (float)block[i] / 4095.0;
+        sum_volume_level += pow(volume_ratio, 2);
+    }
+    return sum_volume_level / (float)n;
+}
+
+int main() {
+    static uint16_t adc[MIC_BLOCK_SIZE] __attribute__((aligned(4)));
+    static int16_t block[MIC_BLOCK_SIZE] __attribute__((aligned(4)));
+    uint32_t state = 1;
+    for (int i = 0; i < MIC_BLOCK_SIZE; i++) {
+        state = state * 1664525 + 1013904223;
+        adc[i] = OFFSET + (int)(state >> 22) - 512;
+    }
+
+    DcFilter dc;
+    Envelope env;
+    dsp_dc_init(&dc, OFFSET);
+    dsp_envelope_init(&env, 2, 8);
+
+    uint64_t ns_float = 0, ns_dc = 0, ns_sum = 0, ns_peak = 0, ns_env = 0;
+    volatile float sink_float;
+    volatile uint32_t sink;
+    for (int r = 0; r < BLOCKS; r++) {
+        uint32_t start = cycle_counter_now();
+        sink_float = get_mean_vu_value_float(adc, MIC_BLOCK_SIZE);
+        ns_float += cycle_counter_elapsed(start);
+
+        start = cycle_counter_now();
+        dsp_dc_remove(&dc, adc, block, MIC_BLOCK_SIZE);
+        ns_dc += cycle_counter_elapsed(start);
+
+        start = cycle_counter_now();
+        sink = dsp_rms(dsp_sum_squares(block, MIC_BLOCK_SIZE), MIC_BLOCK_SIZE);
+        ns_sum += cycle_counter_elapsed(start);
+
+        start = cycle_counter_now();
+        sink = dsp_peak(block, MIC_BLOCK_SIZE);
+        ns_peak += cycle_counter_elapsed(start);
+
+        start = cycle_counter_now();
+        sink = dsp_envelope(&env, block, MIC_BLOCK_SIZE);
+        ns_env += cycle_counter_elapsed(start);
+    }
+    (void)sink_float; (void)sink;
+
+    const double samples = (double)BLOCKS * MIC_BLOCK_SIZE;
+    printf("VU float/pow: %6.2f %s/amostra\n", ns_float / samples, CYCLE_COUNTER_UNIT);
+    printf("DC remove:    %6.2f %s/amostra\n", ns_dc / samples, CYCLE_COUNTER_UNIT);
+    printf("Sum sq + RMS: %6.2f %s/amostra\n", ns_sum / samples, CYCLE_COUNTER_UNIT);
+    printf("Peak:         %6.2f %s/amostra\n", ns_peak / samples, CYCLE_COUNTER_UNIT);
+    printf("Envelope:     %6.2f %s/amostra\n", ns_env / samples, CYCLE_COUNTER_UNIT);
+    return 0;
+}
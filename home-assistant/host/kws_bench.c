@@ -0,0 +1,319 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "audio_config.h"
+#include "kws.h"
+#include "wav.h"
+
+// Compara o MFCC em ponto fixo e a DS-CNN int8 do firmware com uma
+// referência em ponto flutuante (mesmas escalas e topologia) e mede o custo
+// de cada etapa. Entrada: WAVs (reamostrados para 16 kHz) ou, sem arquivos,
+// um sinal sintético de 4 s com tons, varreduras e ruído.
+//
+// --weights lê um KwsModel binário (o mesmo layout da struct); sem ele,
+// usa os pesos de teste não treinados do firmware.
+
+#define PI 3.14159265358979323846
+#define MAX_FRAMES 4096
+
+typedef struct {
+    double mfcc_abs_sum, mfcc_abs_max;
+    uint32_t mfcc_values;
+    uint32_t windows, top1_agree;
+    double logit_abs_sum;
+    double mfcc_seconds, infer_seconds;
+    uint32_t frames;
+} Report;
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ---- Referência em ponto flutuante do MFCC ----
+
+// Escalas do caminho em ponto fixo: janela com x * 8 em Q15, FFT escalada
+// por 1/N, banco mel com pesos em Q8 e MFCC_ENERGY_FLOOR antes do log
+static void reference_mfcc(const double *frame, double *coeffs) {
+    const uint8_t *edges = mfcc_mel_edges();
+    double re[MFCC_FRAME], power[SPECTRUM_BINS], energy[MFCC_MEL_BANDS] = {0};
+
+    for (int i = 0; i < MFCC_FRAME; i++)
+        re[i] = frame[i] * 8 * 0.5 * (1 - cos(2 * PI * i / MFCC_FRAME));
+
+    for (int k = 0; k < SPECTRUM_BINS; k++) {
+        double xr = 0, xi = 0;
+        for (int i = 0; i < MFCC_FRAME; i++) {
+            xr += re[i] * cos(2 * PI * k * i / MFCC_FRAME);
+            xi -= re[i] * sin(2 * PI * k * i / MFCC_FRAME);
+        }
+        xr /= MFCC_FRAME;
+        xi /= MFCC_FRAME;
+        power[k] = xr * xr + xi * xi;
+    }
+
+    for (int b = 0; b < MFCC_MEL_BANDS; b++) {
+        for (int k = edges[b]; k < edges[b + 2]; k++) {
+            double w = k < edges[b + 1] ? (double)(k - edges[b]) / (edges[b + 1] - edges[b])
+                                        : 1 - (double)(k - edges[b + 1]) / (edges[b + 2] - edges[b + 1]);
+            energy[b] += power[k] * w * 256;
+        }
+    }
+
+    for (int k = 1; k <= MFCC_COEFFS; k++) {
+        double c = 0;
+        for (int b = 0; b < MFCC_MEL_BANDS; b++)
+            c += log2(energy[b] + MFCC_ENERGY_FLOOR) * sqrt(2.0 / MFCC_MEL_BANDS)
+               * cos(PI * k * (2 * b + 1) / (2 * MFCC_MEL_BANDS));
+        coeffs[k - 1] = c * (1 << MFCC_OUTPUT_SHIFT);
+    }
+}
+
+// ---- Referência em ponto flutuante da DS-CNN ----
+
+static double relu(double x) {
+    return x > 0 ? x : 0;
+}
+
+static void reference_infer(const KwsModel *m, const int8_t (*input)[MFCC_COEFFS], double *logits) {
+    static double a[KWS_OUT_T][KWS_OUT_F][KWS_CHANNELS], b[KWS_OUT_T][KWS_OUT_F][KWS_CHANNELS];
+    const int pad_t = ((KWS_OUT_T - 1) * 2 + KWS_CONV_T - KWS_FRAMES) / 2;
+    const int pad_f = ((KWS_OUT_F - 1) * 2 + KWS_CONV_F - MFCC_COEFFS) / 2;
+    double in_scale = ldexp(1, -m->input_exp);
+    double w_scale = ldexp(1, -m->conv_q.w_exp);
+
+    for (int t = 0; t < KWS_OUT_T; t++)
+        for (int f = 0; f < KWS_OUT_F; f++)
+            for (int c = 0; c < KWS_CHANNELS; c++) {
+                double acc = m->conv_b[c] * in_scale * w_scale;
+                for (int kt = 0; kt < KWS_CONV_T; kt++)
+                    for (int kf = 0; kf < KWS_CONV_F; kf++) {
+                        int it = t * 2 + kt - pad_t, jf = f * 2 + kf - pad_f;
+                        if (it >= 0 && it < KWS_FRAMES && jf >= 0 && jf < MFCC_COEFFS)
+                            acc += input[it][jf] * in_scale * m->conv_w[kt][kf][c] * w_scale;
+                    }
+                a[t][f][c] = relu(acc);
+            }
+
+    double in_exp_scale = ldexp(1, -m->conv_q.out_exp);
+    for (int i = 0; i < KWS_BLOCKS; i++) {
+        const KwsBlock *blk = &m->blocks[i];
+        double dw_scale = ldexp(1, -blk->dw_q.w_exp), pw_scale = ldexp(1, -blk->pw_q.w_exp);
+        double dw_out_scale = ldexp(1, -blk->dw_q.out_exp);
+
+        for (int t = 0; t < KWS_OUT_T; t++)
+            for (int f = 0; f < KWS_OUT_F; f++)
+                for (int c = 0; c < KWS_CHANNELS; c++) {
+                    double acc = blk->dw_b[c] * in_exp_scale * dw_scale;
+                    for (int kt = 0; kt < 3; kt++)
+                        for (int kf = 0; kf < 3; kf++) {
+                            int it = t + kt - 1, jf = f + kf - 1;
+                            if (it >= 0 && it < KWS_OUT_T && jf >= 0 && jf < KWS_OUT_F)
+                                acc += a[it][jf][c] * blk->dw_w[kt][kf][c] * dw_scale;
+                        }
+                    b[t][f][c] = relu(acc);
+                }
+
+        for (int t = 0; t < KWS_OUT_T; t++)
+            for (int f = 0; f < KWS_OUT_F; f++)
+                for (int o = 0; o < KWS_CHANNELS; o++) {
+                    double acc = blk->pw_b[o] * dw_out_scale * pw_scale;
+                    for (int c = 0; c < KWS_CHANNELS; c++)
+                        acc += b[t][f][c] * blk->pw_w[o][c] * pw_scale;
+                    a[t][f][o] = relu(acc);
+                }
+        in_exp_scale = ldexp(1, -blk->pw_q.out_exp);
+    }
+
+    double pooled[KWS_CHANNELS] = {0};
+    for (int t = 0; t < KWS_OUT_T; t++)
+        for (int f = 0; f < KWS_OUT_F; f++)
+            for (int c = 0; c < KWS_CHANNELS; c++)
+                pooled[c] += a[t][f][c] / (KWS_OUT_T * KWS_OUT_F);
+
+    double fc_scale = ldexp(1, -m->fc_q.w_exp);
+    for (int l = 0; l < KWS_LABELS; l++) {
+        double acc = m->fc_b[l] * in_exp_scale * fc_scale;
+        for (int c = 0; c < KWS_CHANNELS; c++)
+            acc += pooled[c] * m->fc_w[l][c] * fc_scale;
+        logits[l] = acc;
+    }
+}
+
+static int argmax(const double *x, int n) {
+    int best = 0;
+    for (int i = 1; i < n; i++)
+        if (x[i] > x[best])
+            best = i;
+    return best;
+}
+
+// ---- Entradas ----
+
+// Reamostra linearmente para 16 kHz e reduz a 12 bits sem DC, como o firmware
+static int16_t *load_wav(const char *path, uint32_t *length) {
+    WavAudio audio;
+    if (wav_read(path, &audio) < 0)
+        return NULL;
+
+    uint64_t n = (uint64_t)audio.length * MIC_SAMPLE_RATE / audio.sample_rate;
+    n -= n % MIC_BLOCK_SIZE;
+    int16_t *x = malloc(n * sizeof(int16_t) + 1);
+    for (uint64_t i = 0; i < n; i++) {
+        double pos = (double)i * audio.sample_rate / MIC_SAMPLE_RATE;
+        uint32_t j = (uint32_t)pos;
+        double s = audio.samples[j];
+        if (j + 1 < audio.length)
+            s += (audio.samples[j + 1] - s) * (pos - j);
+        x[i] = (int16_t)(s / 16);
+    }
+    wav_free(&audio);
+    *length = (uint32_t)n;
+    return x;
+}
+
+// Vogais sintéticas (harmônicos com formantes), varredura e ruído
+static int16_t *synthetic(uint32_t *length) {
+    uint32_t n = 4 * MIC_SAMPLE_RATE;
+    int16_t *x = malloc(n * sizeof(int16_t));
+    uint32_t seed = 1;
+
+    for (uint32_t i = 0; i < n; i++) {
+        double t = (double)i / MIC_SAMPLE_RATE, s = 0;
+        if (t < 1) {
+            for (int h = 1; h < 20; h++)
+                s += sin(2 * PI * 140 * h * t) * exp(-pow((140 * h - 700) / 300.0, 2)) * 600;
+        } else if (t < 2) {
+            s = sin(2 * PI * (200 + 1500 * (t - 1)) * (t - 1)) * 800;
+        } else if (t < 3) {
+            seed = seed * 1664525 + 1013904223;
+            s = ((int32_t)(seed >> 16) - 32768) / 64.0;
+        } else {
+            for (int h = 1; h < 20; h++)
+                s += sin(2 * PI * 110 * h * t) * exp(-pow((110 * h - 2300) / 400.0, 2)) * 500;
+        }
+        x[i] = (int16_t)s;
+    }
+    *length = n;
+    return x;
+}
+
+// ---- Execução ----
+
+static void run(const int16_t *x, uint32_t length, const KwsModel *model, Report *report) {
+    static int8_t features[MAX_FRAMES][MFCC_COEFFS];
+    MfccFrontEnd mfcc;
+    uint32_t frames = 0;
+
+    mfcc_init(&mfcc);
+    double start = now_seconds();
+    for (uint32_t s = 0; s + MIC_BLOCK_SIZE <= length && frames < MAX_FRAMES; s += MIC_BLOCK_SIZE)
+        frames += mfcc_process(&mfcc, x + s, MIC_BLOCK_SIZE, features + frames, MAX_FRAMES - frames);
+    report->mfcc_seconds += now_seconds() - start;
+    report->frames += frames;
+
+    // Referência: mesmo decimador (em double) e mesmos quadros
+    uint32_t decimated = length / MFCC_DECIMATION;
+    double *d = calloc(decimated + MFCC_FRAME, sizeof(double));
+    for (uint32_t i = 0; i < decimated; i++) {
+        int64_t j = 2 * (int64_t)i - 5; // Mesma linha de atraso do firmware
+        double acc = 0;
+        const int taps[7] = {-1, 0, 9, 16, 9, 0, -1};
+        for (int k = 0; k < 7; k++)
+            if (j + k >= 0 && j + k < length)
+                acc += taps[k] * x[j + k];
+        d[i] = acc / 32;
+    }
+    for (uint32_t f = 0; f < frames; f++) {
+        // O primeiro quadro começa com MFCC_FRAME - MFCC_HOP zeros
+        double frame[MFCC_FRAME], ref[MFCC_COEFFS];
+        for (int i = 0; i < MFCC_FRAME; i++) {
+            int64_t idx = (int64_t)f * MFCC_HOP + i - (MFCC_FRAME - MFCC_HOP);
+            frame[i] = idx < 0 ? 0 : d[idx];
+        }
+        reference_mfcc(frame, ref);
+        for (int k = 0; k < MFCC_COEFFS; k++) {
+            double r = ref[k] > 127 ? 127 : ref[k] < -128 ? -128 : ref[k];
+            double err = fabs(features[f][k] - r);
+            report->mfcc_abs_sum += err;
+            if (err > report->mfcc_abs_max)
+                report->mfcc_abs_max = err;
+            report->mfcc_values++;
+        }
+    }
+    free(d);
+
+    // Inferência a cada KWS_STRIDE_FRAMES sobre as mesmas features int8
+    double logit_scale = ldexp(1, -model->fc_q.out_exp);
+    for (uint32_t end = KWS_FRAMES; end <= frames; end += KWS_STRIDE_FRAMES) {
+        int8_t logits[KWS_LABELS];
+        double ref[KWS_LABELS], got[KWS_LABELS];
+
+        start = now_seconds();
+        kws_infer(model, features + end - KWS_FRAMES, logits);
+        report->infer_seconds += now_seconds() - start;
+
+        reference_infer(model, features + end - KWS_FRAMES, ref);
+        for (int l = 0; l < KWS_LABELS; l++) {
+            got[l] = logits[l] * logit_scale;
+            report->logit_abs_sum += fabs(got[l] - ref[l]) / logit_scale;
+        }
+        report->top1_agree += argmax(got, KWS_LABELS) == argmax(ref, KWS_LABELS);
+        report->windows++;
+    }
+}
+
+int main(int argc, char **argv) {
+    static KwsModel model;
+    int first_file = 1;
+
+    kws_placeholder_model(&model);
+    if (argc > 2 && !strcmp(argv[1], "--weights")) {
+        FILE *file = fopen(argv[2], "rb");
+        if (!file || fread(&model, sizeof(model), 1, file) != 1) {
+            fprintf(stderr, "%s: esperado um KwsModel de %zu bytes\n", argv[2], sizeof(model));
+            return 2;
+        }
+        fclose(file);
+        first_file = 3;
+    } else {
+        printf("Pesos de teste (não treinados): só custo e fidelidade dos kernels\n");
+    }
+
+    Report report = {0};
+    if (first_file >= argc) {
+        uint32_t length;
+        int16_t *x = synthetic(&length);
+        run(x, length, &model, &report);
+        free(x);
+    }
+    for (int i = first_file; i < argc; i++) {
+        uint32_t length;
+        int16_t *x = load_wav(argv[i], &length);
+        if (!x) {
+            fprintf(stderr, "%s: WAV PCM inválido\n", argv[i]);
+            return 1;
+        }
+        run(x, length, &model, &report);
+        free(x);
+    }
+
+    const KwsStats *stats = kws_stats();
+    printf("MFCC: %u quadros, erro médio %.3f, máximo %.0f (unidades de 1/%d log2)\n",
+           report.frames, report.mfcc_abs_sum / report.mfcc_values, report.mfcc_abs_max,
+           1 << MFCC_OUTPUT_SHIFT);
+    if (report.windows)
+        printf("DS-CNN: %u janelas, top-1 igual à referência em %.1f%%, erro médio %.2f LSB por logit\n",
+               report.windows, 100.0 * report.top1_agree / report.windows,
+               report.logit_abs_sum / (report.windows * KWS_LABELS));
+    printf("Modelo: %u MACs por inferência, %zu bytes de pesos\n", kws_macs(), sizeof(KwsModel));
+    printf("Custo: MFCC %.1f us/quadro, inferência %.1f us/janela "
+           "(última: conv %u, blocos %u, densa %u ns)\n",
+           report.mfcc_seconds * 1e6 / report.frames,
+           report.windows ? report.infer_seconds * 1e6 / report.windows : 0.0,
+           stats->conv, stats->blocks, stats->classifier);
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wav.h"
+
+// Gera as gravações de regressão do detector de sons (WAV + marcações no
+// formato do wav_replay) num diretório. Os sinais são sintéticos e
+// determinísticos: palmas são rajadas de ruído com decaimento de ~8 ms, o som
+// alto é ruído de banda larga sustentado e a "sala barulhenta" é fala
+// simulada (trechos de ruído e tons com amplitude sorteada). Cada cena
+// reproduz uma situação que já quebrou o detector. As marcações levam a
+// classe espectral esperada, para o wav_replay conferir também a classificação.
+
+#define RATE 16000
+#define PI 3.14159265358979
+
+typedef struct {
+    float *x;
+    uint32_t length;
+    FILE *labels;
+} Scene;
+
+static uint32_t rng_state = 12345;
+
+static float noise() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+static uint32_t at(double seconds) {
+    return (uint32_t)(seconds * RATE);
+}
+
+static void label(Scene *s, double seconds, const char *type) {
+    fprintf(s->labels, "%.3f %s\n", seconds, type);
+}
+
+// Fundo de ruído branco de amplitude constante
+static void background(Scene *s, double start, double end, float amplitude) {
+    for (uint32_t i = at(start); i < at(end) && i < s->length; i++)
+        s->x[i] += amplitude * noise();
+}
+
+static void clap(Scene *s, double seconds, float amplitude) {
+    for (uint32_t i = 0; i < at(0.06) && at(seconds) + i < s->length; i++)
+        s->x[at(seconds) + i] += amplitude * expf(-(float)i / (0.008f * RATE)) * noise();
+}
+
+static void double_clap(Scene *s, double seconds, float amplitude) {
+    clap(s, seconds, amplitude);
+    clap(s, seconds + 0.35, amplitude);
+    label(s, seconds + 0.35, "double_clap impulse");
+}
+
+// Som alto: o alarme sai depois de noise_hold_ms (150 ms) acima do limiar
+static void loud_noise(Scene *s, double start, double end, float amplitude) {
+    for (uint32_t i = at(start); i < at(end) && i < s->length; i++) {
+        float fade = fminf(1.0f, (i - at(start)) / (0.02f * RATE));
+        s->x[i] += amplitude * fade * noise();
+    }
+    label(s, start + 0.15, "loud_noise broadband");
+}
+
+// Chiado alto: diferença de ruído branco (passa-altas de 1a ordem), com ~80%
+// da energia acima de fs/4
+static void hiss(Scene *s, double start, double end, float amplitude) {
+    float last = 0;
+    for (uint32_t i = at(start); i < at(end) && i < s->length; i++) {
+        float fade = fminf(1.0f, (i - at(start)) / (0.02f * RATE));
+        float v = noise();
+        s->x[i] += amplitude * fade * (v - last);
+        last = v;
+    }
+    label(s, start + 0.15, "loud_noise high");
+}
+
+// Fala simulada: trechos de 80 a 400 ms de ruído ou de tom, com amplitude
+// sorteada entre quase silêncio e forte, e ataques suaves (sem palmas)
+static void chatter(Scene *s, double start, double end, float amplitude) {
+    uint32_t i = at(start);
+    while (i < at(end) && i < s->length) {
+        uint32_t len = at(0.08 + 0.32 * (noise() * 0.5 + 0.5));
+        float a = amplitude * (noise() * 0.5f + 0.5f);
+        float f = 150 + 350 * (noise() * 0.5f + 0.5f);
+        bool tonal = noise() > 0;
+        for (uint32_t k = 0; k < len && i + k < at(end) && i + k < s->length; k++) {
+            float ramp = fminf(1.0f, fminf(k, len - k) / (0.03f * RATE));
+            float v = tonal ? sinf(2 * PI * f * (i + k) / RATE) : noise();
+            s->x[i + k] += a * ramp * v;
+        }
+        i += len;
+    }
+}
+
+static int scene_begin(Scene *s, const char *dir, const char *name, double seconds) {
+    char path[1024];
+
+    snprintf(path, sizeof(path), "%s/%s.txt", dir, name);
+    s->labels = fopen(path, "w");
+    if (!s->labels) {
+        fprintf(stderr, "%s: não foi possível criar\n", path);
+        return -1;
+    }
+    fprintf(s->labels, "# %s: gerado pelo make_fixtures\n", name);
+    s->length = at(seconds);
+    s->x = calloc(s->length, sizeof(float));
+    return 0;
+}
+
+static int scene_end(Scene *s, const char *dir, const char *name) {
+    char path[1024];
+    int16_t *pcm = malloc(s->length * sizeof(int16_t));
+
+    for (uint32_t i = 0; i < s->length; i++) {
+        float v = s->x[i] * 32767;
+        pcm[i] = v > 32767 ? 32767 : v < -32768 ? -32768 : (int16_t)v;
+    }
+    snprintf(path, sizeof(path), "%s/%s.wav", dir, name);
+    FILE *out = wav_write_begin(path, RATE);
+    if (out) {
+        wav_write_samples(out, pcm, s->length);
+        wav_write_end(out);
+    }
+    fclose(s->labels);
+    free(pcm);
+    free(s->x);
+    if (!out) {
+        fprintf(stderr, "%s: não foi possível criar\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "uso: %s diretório\n", argv[0]);
+        return 2;
+    }
+    const char *dir = argv[1];
+    Scene s;
+    int failures = 0;
+
+    // Sala silenciosa: palmas duplas fortes e fracas, palmas soltas (sem evento)
+    if (scene_begin(&s, dir, "quiet_claps", 12) == 0) {
+        background(&s, 0, 12, 0.003f);
+        double_clap(&s, 1.0, 0.9f);
+        clap(&s, 3.0, 0.9f);
+        double_clap(&s, 5.0, 0.5f);
+        clap(&s, 7.5, 0.6f);
+        double_clap(&s, 10.0, 0.9f);
+        failures += scene_end(&s, dir, "quiet_claps") < 0;
+    }
+
+    // Som alto sustentado entre palmas
+    if (scene_begin(&s, dir, "loud_noise", 10) == 0) {
+        background(&s, 0, 10, 0.003f);
+        double_clap(&s, 1.0, 0.9f);
+        loud_noise(&s, 3.0, 5.0, 0.95f);
+        double_clap(&s, 7.5, 0.9f);
+        failures += scene_end(&s, dir, "loud_noise") < 0;
+    }
+
+    // Chiado agudo: a palma também tem centroide perto de fs/4, e já saiu
+    // como "high" quando os agudos eram testados antes do impulso
+    if (scene_begin(&s, dir, "hiss", 8) == 0) {
+        background(&s, 0, 8, 0.003f);
+        double_clap(&s, 1.0, 0.9f);
+        hiss(&s, 3.0, 5.0, 0.6f);
+        double_clap(&s, 6.0, 0.9f);
+        failures += scene_end(&s, dir, "hiss") < 0;
+    }
+
+    // Conversa flutuante logo antes das palmas: com o desvio do fundo sem
+    // limite, os limiares adaptativos passavam do fundo de escala do ADC e a
+    // palma dupla 300 ms depois da conversa era perdida
+    if (scene_begin(&s, dir, "noisy_room", 14) == 0) {
+        background(&s, 0, 14, 0.003f);
+        chatter(&s, 0.5, 5.0, 0.35f);
+        double_clap(&s, 5.3, 0.9f);
+        chatter(&s, 7.0, 11.0, 0.35f);
+        double_clap(&s, 11.3, 0.9f);
+        failures += scene_end(&s, dir, "noisy_room") < 0;
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,269 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// Toca um arquivo MIDI em tempo real no player da placa, pela porta USB
+// (modo ao vivo do Reprodutor de Música, libs/midi_stream.h). Junta as
+// trilhas, segue as trocas de andamento, manda o relógio MIDI (0xF8, 24 por
+// semínima) para o firmware medir o jitter da entrada e usa running status.
+// As linhas "midi ..." que a placa manda a cada segundo (atrasadas,
+// descartadas, pior atraso, jitter) são repassadas para a saída de erro.
+
+#define CLOCKS_PER_QUARTER 24
+
+typedef struct {
+    uint64_t tick;
+    uint32_t order;           // Ordem no arquivo, para eventos no mesmo tique
+    uint8_t bytes[3];
+    uint8_t length;           // 0: troca de andamento (tempo_us)
+    uint32_t tempo_us;
+    uint64_t time_us;         // Preenchido depois, pelo mapa de andamento
+} SendEvent;
+
+typedef struct {
+    SendEvent *e;
+    size_t n, cap;
+} EventList;
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static void push(EventList *list, SendEvent e) {
+    if (list->n == list->cap) {
+        list->cap = list->cap ? list->cap * 2 : 1024;
+        list->e = realloc(list->e, list->cap * sizeof(SendEvent));
+    }
+    e.order = list->n;
+    list->e[list->n++] = e;
+}
+
+static int by_tick(const void *a, const void *b) {
+    const SendEvent *x = a, *y = b;
+    if (x->tick != y->tick)
+        return x->tick < y->tick ? -1 : 1;
+    return x->order < y->order ? -1 : 1;
+}
+
+static uint32_t be32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+static uint32_t read_varlen(const uint8_t **p, const uint8_t *end) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4 && *p < end; i++) {
+        uint8_t b = *(*p)++;
+        value = value << 7 | (b & 0x7F);
+        if (!(b & 0x80))
+            break;
+    }
+    return value;
+}
+
+// Eventos de canal e de andamento de todas as trilhas, em tiques
+static int load_midi(const char *path, EventList *list, uint16_t *division) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = malloc(size);
+    size_t got = fread(data, 1, size, f);
+    fclose(f);
+
+    if (got != (size_t)size || size < 14 || memcmp(data, "MThd", 4) || (data[12] & 0x80)) {
+        fprintf(stderr, "%s: só MIDI com tiques por semínima\n", path);
+        free(data);
+        return -1;
+    }
+    uint16_t tracks = data[10] << 8 | data[11];
+    *division = data[12] << 8 | data[13];
+
+    const uint8_t *p = data + 8 + be32(data + 4), *end = data + size;
+    for (int t = 0; t < tracks && p + 8 <= end; t++) {
+        const uint8_t *q = p + 8, *track_end = q + be32(p + 4) > end ? end : q + be32(p + 4);
+        bool is_track = !memcmp(p, "MTrk", 4);
+        p = track_end;
+        if (!is_track)
+            continue;
+
+        uint64_t tick = 0;
+        uint8_t status = 0;
+        while (q < track_end) {
+            tick += read_varlen(&q, track_end);
+            if (q >= track_end)
+                break;
+            if (*q & 0x80)
+                status = *q++;
+            if (status == 0xFF) {
+                uint8_t type = q < track_end ? *q++ : 0;
+                uint32_t len = read_varlen(&q, track_end);
+                if (type == 0x51 && len == 3 && q + 3 <= track_end)
+                    push(list, (SendEvent){.tick = tick, .tempo_us = q[0] << 16 | q[1] << 8 | q[2]});
+                q += len;
+                status = 0;
+                continue;
+            }
+            if (status == 0xF0 || status == 0xF7) {
+                q += read_varlen(&q, track_end);
+                status = 0;
+                continue;
+            }
+            int bytes = (status & 0xE0) == 0xC0 ? 1 : 2;
+            if (status < 0x80 || q + bytes > track_end)
+                break;
+            SendEvent e = {.tick = tick, .length = 1 + bytes, .bytes = {status, q[0], bytes > 1 ? q[1] : 0}};
+            push(list, e);
+            q += bytes;
+        }
+    }
+    free(data);
+    return 0;
+}
+
+// Relógio a cada 1/24 de semínima e conversão de tiques para us
+static void schedule(EventList *list, uint16_t division) {
+    uint64_t last = 0;
+    for (size_t i = 0; i < list->n; i++)
+        if (list->e[i].tick > last)
+            last = list->e[i].tick;
+    for (uint64_t k = 0; k * division / CLOCKS_PER_QUARTER <= last; k++)
+        push(list, (SendEvent){.tick = k * division / CLOCKS_PER_QUARTER, .length = 1, .bytes = {0xF8}});
+
+    qsort(list->e, list->n, sizeof(SendEvent), by_tick);
+    uint32_t tempo = 500000;
+    uint64_t base_tick = 0, base_us = 0;
+    for (size_t i = 0; i < list->n; i++) {
+        SendEvent *e = &list->e[i];
+        e->time_us = base_us + (e->tick - base_tick) * tempo / division;
+        if (e->length == 0) {
+            base_us = e->time_us;
+            base_tick = e->tick;
+            tempo = e->tempo_us;
+        }
+    }
+}
+
+static int open_port(const char *path) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0)
+        return -1;
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+// Repassa as linhas de estatística da placa
+static void forward_stats(int fd) {
+    static char line[256];
+    static size_t fill = 0;
+    char c;
+
+    while (read(fd, &c, 1) == 1) {
+        if (c == '\n' || fill == sizeof(line) - 1) {
+            line[fill] = '\0';
+            if (!strncmp(line, "midi ", 5))
+                fprintf(stderr, "%s\n", line);
+            fill = 0;
+        } else if (c != '\r')
+            line[fill++] = c;
+    }
+}
+
+static void sleep_until(const struct timespec *start, uint64_t us) {
+    struct timespec t = *start;
+    t.tv_sec += us / 1000000;
+    t.tv_nsec += (us % 1000000) * 1000;
+    if (t.tv_nsec >= 1000000000) {
+        t.tv_sec++;
+        t.tv_nsec -= 1000000000;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR && !stop)
+        ;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "uso: %s /dev/ttyACM0 música.mid\n", argv[0]);
+        return 2;
+    }
+
+    EventList list = {0};
+    uint16_t division;
+    if (load_midi(argv[2], &list, &division) < 0)
+        return 1;
+    schedule(&list, division);
+
+    int fd = open_port(argv[1]);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint8_t running = 0;
+    uint32_t sent = 0;
+
+    for (size_t i = 0; i < list.n && !stop; i++) {
+        const SendEvent *e = &list.e[i];
+        if (e->length == 0)
+            continue;
+        sleep_until(&start, e->time_us);
+
+        // Running status: o status só vai quando muda (o relógio não o cancela)
+        const uint8_t *bytes = e->bytes;
+        int length = e->length;
+        if (bytes[0] < 0xF0) {
+            if (bytes[0] == running) {
+                bytes++;
+                length--;
+            }
+            running = e->bytes[0];
+        }
+        if (write(fd, bytes, length) != length && errno != EAGAIN) {
+            fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+            break;
+        }
+        sent += e->bytes[0] != 0xF8;
+        forward_stats(fd);
+    }
+
+    // Todas as notas desligadas em cada canal, e mais um pouco para as últimas estatísticas
+    for (int c = 0; c < 16; c++) {
+        uint8_t off[3] = {0xB0 | c, 123, 0};
+        if (write(fd, off, 3) != 3)
+            break;
+    }
+    for (int i = 0; i < 15 && !stop; i++) {
+        usleep(100000);
+        forward_stats(fd);
+    }
+    close(fd);
+    printf("%s: %u mensagens em %.1f s\n", argv[2], sent,
+           list.n ? list.e[list.n - 1].time_us / 1e6 : 0.0);
+    free(list.e);
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "note_pitch.h"
+
+// Relatório da tabela de afinação do PWM (libs/note_pitch.h): para cada nota,
+// o divisor e o topo escolhidos na compilação, a frequência que o PWM
+// realmente gera e o erro em cents. Para comparação, mostra o erro da mesma
+// nota arredondada para Hz inteiros, como era a tabela antiga.
+//
+// Para conferir outro clk_sys, compile com -DSYS_CLK_KHZ=... (por exemplo,
+// cmake -DCMAKE_C_FLAGS=-DSYS_CLK_KHZ=133000).
+
+typedef struct {
+    const char *name;
+    uint32_t millihertz;
+    NotePwm pwm;
+} NoteEntry;
+
+#define NOTE_ENTRY(name, mhz) {name, mhz, NOTE_PWM(mhz)},
+static const NoteEntry notes[NOTE_COUNT] = {NOTE_LIST(NOTE_ENTRY)};
+
+static double cents(double f, double target) {
+    return 1200.0 * log2(f / target);
+}
+
+int main(int argc, char **argv) {
+    double limit = 1.0;   // Erro máximo aceito, em cents
+
+    if (argc == 3 && !strcmp(argv[1], "--max-cents"))
+        limit = atof(argv[2]);
+    else if (argc != 1) {
+        fprintf(stderr, "uso: %s [--max-cents C]  (padrão 1; retorna 1 se alguma nota passar)\n", argv[0]);
+        return 2;
+    }
+
+    const double clock = SYS_CLK_KHZ * 1000.0;
+    double worst = 0, worst_integer = 0;
+
+    printf("clk_sys %.0f kHz\n", clock / 1000);
+    printf("nota   alvo (Hz)   divisor    topo  gerada (Hz)   erro (cents)  Hz inteiro (cents)\n");
+    for (int i = 0; i < NOTE_COUNT; i++) {
+        const NoteEntry *n = &notes[i];
+        double target = n->millihertz / 1000.0;
+        double divider = n->pwm.div16 / 16.0;
+        double played = clock / (divider * (n->pwm.wrap + 1));
+        double error = cents(played, target);
+        double integer = cents(floor(target + 0.5), target);
+
+        printf("%-5s %10.3f  %3u.%-4u %7u %12.3f %+14.4f %+19.2f\n", n->name, target,
+               n->pwm.div16 >> 4, (n->pwm.div16 & 0xF) * 625, n->pwm.wrap, played, error, integer);
+        if (fabs(error) > worst)
+            worst = fabs(error);
+        if (fabs(integer) > worst_integer)
+            worst_integer = fabs(integer);
+    }
+    printf("\nPior erro: %.4f cents (Hz inteiros: %.2f cents)\n", worst, worst_integer);
+    return worst > limit;
+}
@@ -0,0 +1,646 @@
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "song_format.h"
+
+// Compila músicas RTTTL (toques de celular) e MIDI simples (formato 0 ou 1)
+// para tabelas no formato compacto de libs/song_format.h, em um arquivo C
+// que o firmware compila junto (songs/song_table.c), ou com --library na
+// imagem binária da biblioteca de músicas na flash (libs/song_library.h).
+// Trechos repetidos em seguida viram SONG_REPEAT/SONG_LOOP.
+//
+// No MIDI, com um só canal melódico ele vira a melodia (com acordes); com
+// mais de um, o canal mais agudo é a melodia e o mais grave o baixo, que
+// fica monofônico (a nota mais grave de cada acorde). O canal 10 (bateria) é
+// ignorado. Os tempos são quantizados para o tique de 1/16 de tempo e o
+// andamento é o primeiro do arquivo.
+
+#define RTTTL_PROGRAM 80      // Lead 1 (square) no General MIDI
+#define MAX_BODY 128          // Maior trecho procurado para repetição
+#define MIDI_CHANNELS 16
+#define MIDI_DRUMS 9
+
+typedef struct {
+    uint16_t *w;
+    size_t n, cap;
+} Words;
+
+typedef struct {
+    uint32_t start, end;      // Em tiques do formato
+    int note;                 // Índice de NOTE_LIST
+    uint8_t channel;
+} NoteEvent;
+
+typedef struct {
+    NoteEvent *e;
+    size_t n, cap;
+} NoteList;
+
+typedef struct {
+    char title[64];
+    char ident[64];
+    uint8_t program;
+    Words melody, bass;
+    uint32_t notes;
+    uint32_t ticks;           // Duração total em tiques
+    uint16_t bpm;
+} CompiledSong;
+
+static void push(Words *words, uint16_t w) {
+    if (words->n == words->cap) {
+        words->cap = words->cap ? words->cap * 2 : 256;
+        words->w = realloc(words->w, words->cap * sizeof(uint16_t));
+    }
+    words->w[words->n++] = w;
+}
+
+static void push_note(NoteList *list, NoteEvent e) {
+    if (list->n == list->cap) {
+        list->cap = list->cap ? list->cap * 2 : 256;
+        list->e = realloc(list->e, list->cap * sizeof(NoteEvent));
+    }
+    list->e[list->n++] = e;
+}
+
+static void push_rest(Words *words, uint32_t ticks) {
+    while (ticks > 0) {
+        uint32_t t = ticks > SONG_MAX_TICKS ? SONG_MAX_TICKS : ticks;
+        push(words, SONG_REST(t));
+        ticks -= t;
+    }
+}
+
+// Procura, a partir de cada posição, o trecho que repetido em seguida mais
+// economiza palavras (REPEAT + LOOP custam duas)
+static void compress(const Words *in, Words *out) {
+    size_t i = 0;
+
+    while (i < in->n) {
+        size_t best_len = 0, best_times = 0;
+        long best_saving = 0;
+
+        for (size_t len = 1; len <= MAX_BODY && i + 2 * len <= in->n; len++) {
+            size_t times = 1;
+            while (i + (times + 1) * len <= in->n && times < 0xFFF &&
+                   !memcmp(in->w + i, in->w + i + times * len, len * sizeof(uint16_t)))
+                times++;
+            long saving = (long)((times - 1) * len) - 2;
+            if (times > 1 && saving > best_saving) {
+                best_saving = saving;
+                best_len = len;
+                best_times = times;
+            }
+        }
+        if (best_len == 0) {
+            push(out, in->w[i++]);
+            continue;
+        }
+        push(out, SONG_REPEAT);
+        for (size_t k = 0; k < best_len; k++)
+            push(out, in->w[i + k]);
+        push(out, SONG_LOOP(best_times));
+        i += best_len * best_times;
+    }
+}
+
+static int by_start(const void *a, const void *b) {
+    const NoteEvent *x = a, *y = b;
+    if (x->start != y->start)
+        return x->start < y->start ? -1 : 1;
+    return y->note - x->note;   // Mais aguda primeiro
+}
+
+// Uma voz a partir das notas: notas com o mesmo início formam um acorde (na
+// voz monofônica, fica a mais grave) que soa até o próximo início
+static void build_voice(NoteList *list, bool chords, uint16_t bpm, Words *voice, uint32_t *ticks) {
+    Words raw = {0};
+    uint32_t cursor = 0;
+
+    qsort(list->e, list->n, sizeof(NoteEvent), by_start);
+    for (size_t i = 0; i < list->n;) {
+        size_t j = i;
+        uint32_t start = list->e[i].start, end = list->e[i].end;
+        while (j < list->n && list->e[j].start == start) {
+            if (list->e[j].end > end)
+                end = list->e[j].end;
+            j++;
+        }
+        uint32_t next = j < list->n ? list->e[j].start : end;
+        uint32_t sound = (end < next ? end : next) - start;
+        if (sound < 1)
+            sound = 1;
+        if (sound > SONG_MAX_TICKS)
+            sound = SONG_MAX_TICKS;
+
+        push_rest(&raw, start - cursor);
+        const NoteEvent *last = &list->e[j - 1];
+        for (const NoteEvent *e = &list->e[i]; chords && e < last; e++)
+            push(&raw, SONG_NOTE(e->note, 0));
+        push(&raw, SONG_NOTE(last->note, sound));
+        cursor = start + sound;
+        i = j;
+    }
+
+    push(voice, SONG_TEMPO(bpm));
+    compress(&raw, voice);
+    push(voice, SONG_END);
+    *ticks = cursor;
+    free(raw.w);
+}
+
+// Nome do arquivo sem diretório nem extensão, como identificador C
+static void make_ident(const char *path, char *ident, size_t size) {
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    size_t n = 0;
+
+    if (isdigit((unsigned char)*base) && n + 1 < size)
+        ident[n++] = '_';
+    for (; *base && *base != '.' && n + 1 < size; base++)
+        ident[n++] = isalnum((unsigned char)*base) ? tolower((unsigned char)*base) : '_';
+    ident[n] = '\0';
+}
+
+static char *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *data = malloc(n + 1);
+    if (fread(data, 1, n, f) != (size_t)n) {
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    data[n] = '\0';
+    *size = n;
+    return data;
+}
+
+// --- RTTTL: "nome:d=4,o=5,b=120:8e6,8p,c#.6,..." ---
+
+static const int semitone[7] = {9, 11, 0, 2, 4, 5, 7};   // De a a g
+
+static int parse_rtttl(const char *path, const char *text, CompiledSong *song) {
+    const char *colon = strchr(text, ':');
+    const char *notes = colon ? strchr(colon + 1, ':') : NULL;
+    int def_duration = 4, def_octave = 6, bpm = 63;
+    NoteList list = {0};
+
+    if (!notes) {
+        fprintf(stderr, "%s: RTTTL sem as três seções (nome:padrões:notas)\n", path);
+        return -1;
+    }
+    snprintf(song->title, sizeof(song->title), "%.*s", (int)(colon - text), text);
+
+    for (const char *p = colon + 1; p < notes; p++) {
+        char key = tolower((unsigned char)*p);
+        if ((key == 'd' || key == 'o' || key == 'b') && p[1] == '=') {
+            int value = atoi(p + 2);
+            if (key == 'd') def_duration = value;
+            else if (key == 'o') def_octave = value;
+            else bpm = value;
+        }
+    }
+    if (bpm < 1 || bpm > SONG_MAX_BPM) {
+        fprintf(stderr, "%s: andamento %d fora de 1 a %d\n", path, bpm, SONG_MAX_BPM);
+        return -1;
+    }
+
+    uint32_t cursor = 0;
+    for (const char *p = notes + 1; *p;) {
+        while (*p && (isspace((unsigned char)*p) || *p == ','))
+            p++;
+        if (!*p)
+            break;
+
+        int duration = def_duration, octave = def_octave, note = -1;
+        bool dotted = false;
+        if (isdigit((unsigned char)*p))
+            duration = strtol(p, (char **)&p, 10);
+        char letter = tolower((unsigned char)*p++);
+        if (letter == 'h')
+            letter = 'b';
+        if (letter >= 'a' && letter <= 'g')
+            note = semitone[letter - 'a'];
+        else if (letter != 'p') {
+            fprintf(stderr, "%s: nota '%c' inválida\n", path, letter);
+            return -1;
+        }
+        if (*p == '#') {
+            note++;
+            p++;
+        }
+        if (*p == '.') {
+            dotted = true;
+            p++;
+        }
+        if (isdigit((unsigned char)*p))
+            octave = strtol(p, (char **)&p, 10);
+        if (*p == '.') {
+            dotted = true;
+            p++;
+        }
+
+        if (duration < 1 || duration > 64 || 64 % duration) {
+            fprintf(stderr, "%s: duração 1/%d inválida\n", path, duration);
+            return -1;
+        }
+        uint32_t ticks = 64 / duration;
+        if (dotted)
+            ticks += ticks / 2;
+
+        if (note >= 0) {
+            note += octave * 12;
+            if (note < 0 || note >= NOTE_COUNT) {
+                fprintf(stderr, "%s: nota fora de C0 a B7 (oitava %d)\n", path, octave);
+                return -1;
+            }
+            push_note(&list, (NoteEvent){cursor, cursor + ticks, note, 0});
+            song->notes++;
+        }
+        cursor += ticks;
+    }
+
+    // Sem notas a música dura 0 ms e o player a reiniciaria sem parar
+    if (list.n == 0) {
+        fprintf(stderr, "%s: RTTTL sem notas\n", path);
+        return -1;
+    }
+
+    song->program = RTTTL_PROGRAM;
+    song->bpm = bpm;
+    build_voice(&list, false, bpm, &song->melody, &song->ticks);
+    // Pausa no fim da música
+    if (cursor > song->ticks) {
+        song->melody.n--;
+        push_rest(&song->melody, cursor - song->ticks);
+        push(&song->melody, SONG_END);
+        song->ticks = cursor;
+    }
+    free(list.e);
+    return 0;
+}
+
+// --- MIDI ---
+
+static uint32_t be32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+static uint32_t read_varlen(const uint8_t **p, const uint8_t *end) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4 && *p < end; i++) {
+        uint8_t b = *(*p)++;
+        value = value << 7 | (b & 0x7F);
+        if (!(b & 0x80))
+            break;
+    }
+    return value;
+}
+
+static int parse_midi(const char *path, const uint8_t *data, size_t size, CompiledSong *song) {
+    if (size < 14 || memcmp(data, "MThd", 4) || be32(data + 4) < 6) {
+        fprintf(stderr, "%s: não é um arquivo MIDI\n", path);
+        return -1;
+    }
+    uint16_t format = data[8] << 8 | data[9];
+    uint16_t tracks = data[10] << 8 | data[11];
+    uint16_t division = data[12] << 8 | data[13];
+    if (format > 1 || (division & 0x8000) || division == 0) {
+        fprintf(stderr, "%s: só MIDI formato 0/1 com tiques por semínima\n", path);
+        return -1;
+    }
+
+    NoteList list = {0};
+    uint32_t tempo_us = 0;
+    int programs[MIDI_CHANNELS];
+    bool tempo_changes = false;
+    for (int c = 0; c < MIDI_CHANNELS; c++)
+        programs[c] = -1;
+
+    const uint8_t *p = data + 8 + be32(data + 4), *end = data + size;
+    for (int t = 0; t < tracks && p + 8 <= end; t++) {
+        uint32_t length = be32(p + 4);
+        const uint8_t *q = p + 8, *track_end = q + length > end ? end : q + length;
+        bool is_track = !memcmp(p, "MTrk", 4);
+        p = track_end;
+        if (!is_track)
+            continue;
+
+        uint32_t time = 0;
+        uint8_t status = 0;
+        int32_t on[MIDI_CHANNELS][128];
+        memset(on, 0xFF, sizeof(on));
+
+        while (q < track_end) {
+            time += read_varlen(&q, track_end);
+            if (q >= track_end)
+                break;
+            if (*q & 0x80)
+                status = *q++;
+            if (status == 0xFF) {
+                if (q + 1 > track_end)
+                    break;
+                uint8_t type = *q++;
+                uint32_t len = read_varlen(&q, track_end);
+                if (type == 0x51 && len == 3) {
+                    uint32_t us = q[0] << 16 | q[1] << 8 | q[2];
+                    if (tempo_us == 0) {
+                        tempo_us = us;
+                        tempo_changes |= time > 0;
+                    } else if (us != tempo_us)
+                        tempo_changes = true;
+                } else if (type == 0x03 && t == 0 && !song->title[0])
+                    snprintf(song->title, sizeof(song->title), "%.*s", (int)len, (const char *)q);
+                q += len;
+                status = 0;
+                continue;
+            }
+            if (status == 0xF0 || status == 0xF7) {
+                q += read_varlen(&q, track_end);
+                status = 0;
+                continue;
+            }
+
+            uint8_t kind = status & 0xF0, channel = status & 0x0F;
+            int bytes = kind == 0xC0 || kind == 0xD0 ? 1 : 2;
+            if (kind < 0x80 || q + bytes > track_end)
+                break;
+            uint8_t a = q[0], b = bytes > 1 ? q[1] : 0;
+            q += bytes;
+
+            if (kind == 0xC0 && programs[channel] < 0)
+                programs[channel] = a;
+            if (channel == MIDI_DRUMS || (kind != 0x80 && kind != 0x90))
+                continue;
+            a &= 0x7F;
+            if (on[channel][a] >= 0) {
+                // Fecha a nota aberta (nota desligada ou religada sem desligar)
+                uint32_t start = on[channel][a];
+                push_note(&list, (NoteEvent){start, time, a, channel});
+                on[channel][a] = -1;
+            }
+            if (kind == 0x90 && b > 0)
+                on[channel][a] = time;
+        }
+        for (int c = 0; c < MIDI_CHANNELS; c++)
+            for (int n = 0; n < 128; n++)
+                if (on[c][n] >= 0)
+                    push_note(&list, (NoteEvent){on[c][n], time, n, c});
+    }
+
+    if (list.n == 0) {
+        fprintf(stderr, "%s: nenhuma nota fora da bateria\n", path);
+        return -1;
+    }
+    if (tempo_us == 0)
+        tempo_us = 500000;
+    if (tempo_changes)
+        fprintf(stderr, "%s: aviso: trocas de andamento ignoradas\n", path);
+    int bpm = (60000000 + tempo_us / 2) / tempo_us;
+    song->bpm = bpm < 1 ? 1 : bpm > SONG_MAX_BPM ? SONG_MAX_BPM : bpm;
+
+    // Canal mais agudo e mais grave pela média das notas
+    long sum[MIDI_CHANNELS] = {0}, count[MIDI_CHANNELS] = {0};
+    for (size_t i = 0; i < list.n; i++) {
+        sum[list.e[i].channel] += list.e[i].note;
+        count[list.e[i].channel]++;
+    }
+    int high = -1, low = -1, channels = 0;
+    for (int c = 0; c < MIDI_CHANNELS; c++) {
+        if (!count[c])
+            continue;
+        channels++;
+        if (high < 0 || sum[c] * count[high] > sum[high] * count[c])
+            high = c;
+        if (low < 0 || sum[c] * count[low] < sum[low] * count[c])
+            low = c;
+    }
+    if (channels > 2)
+        fprintf(stderr, "%s: aviso: %d canais; só o mais agudo e o mais grave tocam\n", path, channels);
+
+    // Quantiza para o tique e separa as vozes, trazendo notas fora de C0 a B7 por oitavas
+    NoteList melody = {0}, bass = {0};
+    uint32_t shifted = 0;
+    for (size_t i = 0; i < list.n; i++) {
+        NoteEvent e = list.e[i];
+        e.start = ((uint64_t)e.start * SONG_TICKS_PER_BEAT + division / 2) / division;
+        e.end = ((uint64_t)e.end * SONG_TICKS_PER_BEAT + division / 2) / division;
+        e.note -= 12;   // Nota MIDI 12 é C0
+        if (e.note < 0 || e.note >= NOTE_COUNT)
+            shifted++;
+        while (e.note < 0)
+            e.note += 12;
+        while (e.note >= NOTE_COUNT)
+            e.note -= 12;
+        if (e.channel == high)
+            push_note(&melody, e);
+        else if (e.channel == low)
+            push_note(&bass, e);
+    }
+    if (shifted)
+        fprintf(stderr, "%s: aviso: %u notas fora de C0 a B7 mudadas de oitava\n", path, shifted);
+
+    uint32_t bass_ticks = 0;
+    song->program = programs[high] < 0 ? 0 : programs[high];
+    song->notes = melody.n + bass.n;
+    build_voice(&melody, true, song->bpm, &song->melody, &song->ticks);
+    if (bass.n) {
+        build_voice(&bass, false, song->bpm, &song->bass, &bass_ticks);
+        if (bass_ticks > song->ticks)
+            song->ticks = bass_ticks;
+    }
+    free(list.e);
+    free(melody.e);
+    free(bass.e);
+    return 0;
+}
+
+// --- Saída ---
+
+static void write_words(FILE *out, const char *ident, const char *voice, const Words *words) {
+    fprintf(out, "static const uint16_t %s_%s[] = {", ident, voice);
+    for (size_t i = 0; i < words->n; i++)
+        fprintf(out, "%s0x%04X,", i % 10 ? " " : "\n    ", words->w[i]);
+    fprintf(out, "\n};\n");
+}
+
+// Título em ASCII imprimível, cortado para uma linha do display
+static void ascii_title(const char *title, char *out) {
+    int n = 0;
+    for (; *title && n < SONG_TITLE_CHARS; title++)
+        if ((unsigned char)*title >= 32 && (unsigned char)*title < 127)
+            out[n++] = *title;
+    out[n] = '\0';
+}
+
+static void write_title(FILE *out, const char *title) {
+    char text[SONG_TITLE_CHARS + 1];
+    ascii_title(title, text);
+    fputc('"', out);
+    for (const char *c = text; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', out);
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+static uint32_t duration_ms(const CompiledSong *song) {
+    return (uint64_t)song->ticks * 3750 / song->bpm;
+}
+
+static int write_table(FILE *out, const CompiledSong *songs, int count) {
+    fprintf(out, "// Gerado pelo host/song_compiler a partir de songs/ (não editar)\n\n");
+    fprintf(out, "#include <stddef.h>\n#include \"libs/song_format.h\"\n");
+
+    for (int s = 0; s < count; s++) {
+        const CompiledSong *song = &songs[s];
+        size_t bytes = (song->melody.n + song->bass.n) * sizeof(uint16_t);
+        uint32_t seconds = duration_ms(song) / 1000;
+
+        fprintf(out, "\n// %s: %u notas, %u:%02u, %zu bytes\n", song->title, song->notes,
+                seconds / 60, seconds % 60, bytes);
+        write_words(out, song->ident, "melody", &song->melody);
+        if (song->bass.n)
+            write_words(out, song->ident, "bass", &song->bass);
+    }
+
+    fprintf(out, "\nconst PackedSong compiled_songs[] = {\n");
+    for (int s = 0; s < count; s++) {
+        fprintf(out, "    {");
+        write_title(out, songs[s].title);
+        fprintf(out, ", %u, %s_melody, ", songs[s].program, songs[s].ident);
+        if (songs[s].bass.n)
+            fprintf(out, "%s_bass, ", songs[s].ident);
+        else
+            fprintf(out, "NULL, ");
+        fprintf(out, "%u},\n", duration_ms(&songs[s]));
+    }
+    fprintf(out, "};\n\nconst int compiled_song_count = %d;\n", count);
+    return 0;
+}
+
+// Imagem da biblioteca para a flash: cabeçalho, índice e as vozes em seguida
+static int write_library(FILE *out, const CompiledSong *songs, int count) {
+    uint32_t offset = sizeof(SongLibraryHeader) + count * sizeof(SongLibraryEntry);
+    SongLibraryEntry *index = calloc(count, sizeof(SongLibraryEntry));
+
+    for (int s = 0; s < count; s++) {
+        SongLibraryEntry *e = &index[s];
+        char title[SONG_TITLE_CHARS + 1];
+        ascii_title(songs[s].title, title);
+        memcpy(e->title, title, strlen(title));
+        e->program = songs[s].program;
+        e->duration_ms = duration_ms(&songs[s]);
+        e->melody = offset;
+        e->melody_words = songs[s].melody.n;
+        offset += songs[s].melody.n * sizeof(uint16_t);
+        if (songs[s].bass.n) {
+            e->bass = offset;
+            e->bass_words = songs[s].bass.n;
+            offset += songs[s].bass.n * sizeof(uint16_t);
+        }
+    }
+    if (count > 0xFFFF || offset > SONG_LIBRARY_MAX_BYTES) {
+        fprintf(stderr, "biblioteca de %u bytes passa do limite de %u\n", offset, SONG_LIBRARY_MAX_BYTES);
+        free(index);
+        return 1;
+    }
+
+    SongLibraryHeader header = {SONG_LIBRARY_MAGIC, SONG_LIBRARY_VERSION, count, offset, 0};
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(index, sizeof(SongLibraryEntry), count, out);
+    for (int s = 0; s < count; s++) {
+        fwrite(songs[s].melody.w, sizeof(uint16_t), songs[s].melody.n, out);
+        fwrite(songs[s].bass.w, sizeof(uint16_t), songs[s].bass.n, out);
+    }
+    fprintf(stderr, "biblioteca: %d músicas, %u bytes (%.1f%% da região)\n", count, offset,
+            100.0 * offset / SONG_LIBRARY_MAX_BYTES);
+    free(index);
+    return 0;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+        "uso: %s [-o saída] [--library] [-p programa] música.rtttl|música.mid ...\n"
+        "  -o         arquivo de saída (padrão: saída padrão)\n"
+        "  --library  gera a imagem binária da biblioteca na flash em vez do C\n"
+        "  -p         instrumento General MIDI (0 a 127) das músicas seguintes\n"
+        "             (padrão: %d no RTTTL, o program change do canal da melodia no MIDI)\n",
+        name, RTTTL_PROGRAM);
+}
+
+int main(int argc, char **argv) {
+    const char *out_path = NULL;
+    bool library = false;
+    int program = -1;
+    CompiledSong *songs = calloc(argc, sizeof(CompiledSong));
+    int count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            out_path = argv[++i];
+            continue;
+        }
+        if (!strcmp(argv[i], "--library")) {
+            library = true;
+            continue;
+        }
+        if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+            program = atoi(argv[++i]) & 0x7F;
+            continue;
+        }
+        if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 2;
+        }
+
+        size_t size;
+        char *data = read_file(argv[i], &size);
+        if (!data) {
+            fprintf(stderr, "%s: %s\n", argv[i], strerror(errno));
+            return 1;
+        }
+        CompiledSong *song = &songs[count];
+        make_ident(argv[i], song->ident, sizeof(song->ident));
+        for (int k = 0; k < count; k++)
+            if (!strcmp(songs[k].ident, song->ident))
+                snprintf(song->ident + strlen(song->ident), sizeof(song->ident) - strlen(song->ident), "_%d", count);
+        int error = size >= 4 && !memcmp(data, "MThd", 4)
+                    ? parse_midi(argv[i], (const uint8_t *)data, size, song)
+                    : parse_rtttl(argv[i], data, song);
+        free(data);
+        if (error)
+            return 1;
+        if (!song->title[0])
+            snprintf(song->title, sizeof(song->title), "%s", song->ident);
+        if (program >= 0)
+            song->program = program;
+        count++;
+    }
+    if (count == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    for (int s = 0; s < count; s++)
+        fprintf(stderr, "%-24s %5u notas  %6zu bytes  (%u bytes com Tone)\n", songs[s].title, songs[s].notes,
+                (songs[s].melody.n + songs[s].bass.n) * sizeof(uint16_t), songs[s].notes * 8);
+
+    FILE *out = out_path ? fopen(out_path, library ? "wb" : "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "%s: %s\n", out_path, strerror(errno));
+        return 1;
+    }
+    int error = library ? write_library(out, songs, count) : write_table(out, songs, count);
+    if (out != stdout)
+        fclose(out);
+    return error;
+}
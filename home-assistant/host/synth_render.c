@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "synth.h"
+#include "wav.h"
+
+// Renderiza com o sintetizador do firmware (libs/synth.c) uma sequência de
+// acordes em cada forma de onda, para ouvir os timbres e o envelope sem a
+// placa, e mede o custo por amostra com 1 a SYNTH_VOICES vozes.
+
+#define RATE 22050
+#define BLOCK 256
+
+static const char *wave_names[SYNTH_WAVES] = {"seno", "quadrada", "dente de serra", "órgão"};
+
+// C, G, Am, F (mHz)
+static const uint32_t chords[4][3] = {
+    {261626, 329628, 391995},
+    {195998, 246942, 293665},
+    {220000, 261626, 329628},
+    {174614, 220000, 261626},
+};
+
+static void render(Synth *synth, FILE *out, uint32_t samples) {
+    int16_t block[BLOCK];
+
+    for (uint32_t s = 0; s < samples; s += BLOCK) {
+        synth_render(synth, block, BLOCK);
+        if (out)
+            wav_write_samples(out, block, BLOCK);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        fprintf(stderr, "uso: %s [saida.wav]\n", argv[0]);
+        return 2;
+    }
+
+    FILE *out = NULL;
+    if (argc == 2 && !(out = wav_write_begin(argv[1], RATE))) {
+        fprintf(stderr, "%s: não foi possível criar\n", argv[1]);
+        return 1;
+    }
+
+    Synth synth;
+    synth_init(&synth, RATE);
+    for (int w = 0; w < SYNTH_WAVES; w++) {
+        SynthInstrument instrument = {(uint8_t)w, 20, 150, 22000, 150, 10000};
+        synth_set_instrument(&synth, &instrument);
+        for (int c = 0; c < 4; c++) {
+            for (int n = 0; n < 3; n++)
+                synth_note_on(&synth, chords[c][n]);
+            render(&synth, out, RATE * 8 / 10);
+            synth_release_all(&synth);
+            render(&synth, out, RATE / 5);
+        }
+    }
+    if (out) {
+        wav_write_end(out);
+        printf("%s: %d timbres (%s, %s, %s, %s)\n", argv[1], SYNTH_WAVES,
+               wave_names[0], wave_names[1], wave_names[2], wave_names[3]);
+    }
+
+    // Custo por amostra com vozes sustentadas
+    static const SynthInstrument pad = {SYNTH_WAVE_SAW, 1, 1, 32767, 1000, 5000};
+    synth_set_instrument(&synth, &pad);
+    for (int voices = 1; voices <= SYNTH_VOICES; voices++) {
+        synth_silence(&synth);
+        for (int v = 0; v < voices; v++)
+            synth_note_on(&synth, 220000 + 55000 * v);
+
+        uint64_t total = 0;
+        const int blocks = 2000;
+        int16_t block[BLOCK];
+        for (int b = 0; b < blocks; b++) {
+            synth_render(&synth, block, BLOCK);
+            total += synth.cost;
+        }
+        printf("%d vozes: %.1f ns/amostra\n", voices, (double)total / ((double)blocks * BLOCK));
+    }
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "adpcm.h"
+#include "wav.h"
+
+// Recebe a captura do microfone pela USB (quadros IMA-ADPCM do detector de
+// sons) e grava um WAV. Quadros perdidos viram silêncio do mesmo tamanho,
+// então a linha do tempo do arquivo continua alinhada com o áudio real e as
+// marcações do wav_replay valem para a gravação.
+//
+// No firmware, abra a Detecção de Sons: este programa envia 'c' para ligar
+// a captura e 's' ao terminar (Ctrl+C ou --seconds).
+
+#define READ_BUFFER (16 * ADPCM_FRAME_BYTES)
+#define IDLE_TIMEOUT 2.0   // Segundos sem quadros antes de desistir
+
+typedef struct {
+    uint32_t frames;       // Quadros válidos
+    uint32_t dropped;      // Quadros que faltaram na sequência
+    uint32_t corrupted;    // Marcadores com CRC errado
+    uint32_t out_of_order; // Quadros repetidos ou atrasados (descartados)
+    uint64_t skipped;      // Bytes fora de quadros (texto do printf, ruído)
+    uint64_t samples;      // Amostras gravadas, contando o silêncio das perdas
+} CaptureStats;
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Abre a porta CDC em modo cru (a taxa em baud não importa na USB)
+static int open_port(const char *path) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0)
+        return -1;
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 1;   // read() retorna em até 100 ms
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    tcflush(fd, TCIFLUSH);
+    return fd;
+}
+
+static void print_stats(const CaptureStats *stats, uint32_t rate, double elapsed, const char *end) {
+    fprintf(stderr, "%7.1f s  %u quadros  %u perdidos  %u corrompidos  %.0f amostras/s%s",
+            (double)stats->samples / rate, stats->frames, stats->dropped, stats->corrupted,
+            elapsed > 0 ? stats->samples / elapsed : 0.0, end);
+}
+
+static int capture(const char *port, const char *path, double seconds) {
+    int fd = open_port(port);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", port, strerror(errno));
+        return 1;
+    }
+    if (write(fd, "c", 1) != 1) {
+        fprintf(stderr, "%s: falha ao pedir a captura\n", port);
+        close(fd);
+        return 1;
+    }
+
+    static uint8_t buffer[READ_BUFFER + ADPCM_FRAME_BYTES];
+    static int16_t samples[ADPCM_FRAME_SAMPLES];
+    static const int16_t silence[ADPCM_FRAME_SAMPLES];
+    CaptureStats stats = {0};
+    FILE *wav = NULL;
+    uint32_t rate = 0;
+    uint16_t expected = 0;
+    int fill = 0;
+    double start = now_seconds(), last_frame = start, last_report = start;
+
+    while (!stop) {
+        ssize_t got = read(fd, buffer + fill, READ_BUFFER - fill);
+        if (got < 0 && errno != EINTR) {
+            fprintf(stderr, "\n%s: %s\n", port, strerror(errno));
+            break;
+        }
+        if (got > 0)
+            fill += got;
+
+        // Procura quadros; um marcador com CRC errado avança um byte e tenta de novo
+        int pos = 0;
+        while (fill - pos >= ADPCM_FRAME_BYTES) {
+            const uint8_t *frame = buffer + pos;
+            uint16_t seq, frame_rate;
+
+            if (frame[0] != ADPCM_MAGIC_0 || frame[1] != ADPCM_MAGIC_1) {
+                pos++;
+                stats.skipped++;
+                continue;
+            }
+            if (!adpcm_frame_unpack(frame, &seq, &frame_rate, samples)) {
+                pos++;
+                stats.skipped++;
+                stats.corrupted++;
+                continue;
+            }
+            pos += ADPCM_FRAME_BYTES;
+
+            if (!wav) {
+                rate = frame_rate;
+                wav = wav_write_begin(path, rate);
+                if (!wav) {
+                    fprintf(stderr, "%s: %s\n", path, strerror(errno));
+                    stop = 1;
+                    break;
+                }
+                expected = seq;
+            }
+
+            uint16_t gap = seq - expected;
+            if (gap >= 0x8000) {
+                stats.out_of_order++;
+                continue;
+            }
+            for (uint16_t i = 0; i < gap; i++)
+                wav_write_samples(wav, silence, ADPCM_FRAME_SAMPLES);
+            wav_write_samples(wav, samples, ADPCM_FRAME_SAMPLES);
+            stats.dropped += gap;
+            stats.frames++;
+            stats.samples += (uint64_t)(gap + 1) * ADPCM_FRAME_SAMPLES;
+            expected = seq + 1;
+            last_frame = now_seconds();
+        }
+        memmove(buffer, buffer + pos, fill - pos);
+        fill -= pos;
+
+        double now = now_seconds();
+        if (now - last_frame > IDLE_TIMEOUT) {
+            fprintf(stderr, "\n%s: sem quadros há %.0f s (o detector de sons está aberto?)\n",
+                    port, IDLE_TIMEOUT);
+            break;
+        }
+        if (rate && now - last_report >= 1.0) {
+            print_stats(&stats, rate, now - start, "\r");
+            last_report = now;
+        }
+        if (rate && seconds > 0 && stats.samples >= seconds * rate)
+            break;
+    }
+
+    double elapsed = now_seconds() - start;
+    if (write(fd, "s", 1) != 1)
+        fprintf(stderr, "%s: falha ao parar a captura\n", port);
+    close(fd);
+    if (!wav)
+        return 1;
+    wav_write_end(wav);
+
+    print_stats(&stats, rate, elapsed, "\n");
+    if (stats.out_of_order || stats.skipped)
+        fprintf(stderr, "  %u fora de ordem, %llu bytes fora de quadros\n",
+                stats.out_of_order, (unsigned long long)stats.skipped);
+    printf("%s: %.2f s a %u Hz, %u quadros perdidos (%.2f%%)\n", path, (double)stats.samples / rate,
+           rate, stats.dropped, stats.frames ? 100.0 * stats.dropped / (stats.frames + stats.dropped) : 0.0);
+    return stats.dropped ? 1 : 0;
+}
+
+// Passa um WAV pelos quadros do firmware e mede o erro do ADPCM, sem placa
+static int encode_file(const char *in_path, const char *out_path) {
+    WavAudio audio;
+    if (wav_read(in_path, &audio) < 0) {
+        fprintf(stderr, "%s: WAV PCM inválido\n", in_path);
+        return 1;
+    }
+    FILE *out = wav_write_begin(out_path, audio.sample_rate);
+    if (!out) {
+        fprintf(stderr, "%s: %s\n", out_path, strerror(errno));
+        wav_free(&audio);
+        return 1;
+    }
+
+    uint8_t frame[ADPCM_FRAME_BYTES];
+    int16_t decoded[ADPCM_FRAME_SAMPLES];
+    AdpcmState state;
+    double signal = 0, error = 0;
+    uint32_t length = audio.length - audio.length % ADPCM_FRAME_SAMPLES;
+
+    adpcm_init(&state);
+    for (uint32_t s = 0; s < length; s += ADPCM_FRAME_SAMPLES) {
+        uint16_t seq, rate;
+        adpcm_frame_pack(frame, s / ADPCM_FRAME_SAMPLES, audio.sample_rate, &state, audio.samples + s);
+        adpcm_frame_unpack(frame, &seq, &rate, decoded);
+        wav_write_samples(out, decoded, ADPCM_FRAME_SAMPLES);
+        for (int i = 0; i < ADPCM_FRAME_SAMPLES; i++) {
+            double x = audio.samples[s + i], e = decoded[i] - x;
+            signal += x * x;
+            error += e * e;
+        }
+    }
+    wav_write_end(out);
+    wav_free(&audio);
+
+    printf("%s: %.2f s, SNR %.1f dB, %.1f kB/s na USB\n", in_path, (double)length / audio.sample_rate,
+           error > 0 ? 10 * log10(signal / error) : INFINITY,
+           audio.sample_rate / (double)ADPCM_FRAME_SAMPLES * ADPCM_FRAME_BYTES / 1000);
+    return 0;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+        "uso: %s [--seconds S] /dev/ttyACM0 saida.wav\n"
+        "     %s --encode entrada.wav saida.wav\n"
+        "  --seconds S   para depois de S segundos (padrão: até Ctrl+C)\n"
+        "  --encode      passa um WAV pelo ADPCM do firmware e mostra o SNR\n"
+        "Retorna 1 se algum quadro foi perdido.\n",
+        name, name);
+}
+
+int main(int argc, char **argv) {
+    double seconds = 0;
+    int i = 1;
+
+    if (argc == 4 && !strcmp(argv[1], "--encode"))
+        return encode_file(argv[2], argv[3]);
+    if (i + 1 < argc && !strcmp(argv[i], "--seconds")) {
+        seconds = atof(argv[i + 1]);
+        i += 2;
+    }
+    if (argc - i != 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    return capture(argv[i], argv[i + 1], seconds);
+}
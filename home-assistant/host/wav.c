@@ -0,0 +1,135 @@
+#include <stdlib.h>
+#include <string.h>
+#include "wav.h"
+
+static uint32_t read_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static void write_u32(FILE *file, uint32_t v) {
+    uint8_t b[4] = {v, v >> 8, v >> 16, v >> 24};
+    fwrite(b, 1, 4, file);
+}
+
+static void write_u16(FILE *file, uint16_t v) {
+    uint8_t b[2] = {v, v >> 8};
+    fwrite(b, 1, 2, file);
+}
+
+// Converte uma amostra PCM inteira de 8 a 32 bits para 16 bits
+static int32_t pcm_to_16(const uint8_t *p, int bytes) {
+    switch (bytes) {
+        case 1: return ((int32_t)p[0] - 128) << 8;
+        case 2: return (int16_t)read_u16(p);
+        case 3: return (int16_t)read_u16(p + 1);
+        default: return (int16_t)read_u16(p + 2);
+    }
+}
+
+// Lê um WAV PCM inteiro (8, 16, 24 ou 32 bits, qualquer número de canais).
+// Retorna 0 em caso de sucesso.
+int wav_read(const char *path, WavAudio *audio) {
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return -1;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t *data = malloc(size);
+    if (!data || fread(data, 1, size, file) != (size_t)size || size < 12
+        || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4)) {
+        free(data);
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+
+    uint16_t format = 0, channels = 0, bits = 0;
+    const uint8_t *pcm = NULL;
+    uint32_t pcm_size = 0;
+
+    for (long pos = 12; pos + 8 <= size;) {
+        uint32_t chunk = read_u32(data + pos + 4);
+        if (!memcmp(data + pos, "fmt ", 4) && chunk >= 16) {
+            format = read_u16(data + pos + 8);
+            channels = read_u16(data + pos + 10);
+            audio->sample_rate = read_u32(data + pos + 12);
+            bits = read_u16(data + pos + 22);
+            if (format == 0xFFFE && chunk >= 26)
+                format = read_u16(data + pos + 32); // WAVE_FORMAT_EXTENSIBLE
+        } else if (!memcmp(data + pos, "data", 4)) {
+            pcm = data + pos + 8;
+            pcm_size = chunk;
+            if (pos + 8 + pcm_size > (uint32_t)size)
+                pcm_size = size - pos - 8;
+        }
+        pos += 8 + chunk + (chunk & 1);
+    }
+
+    int bytes = bits / 8;
+    if (format != 1 || !pcm || channels == 0 || bytes < 1 || bytes > 4) {
+        free(data);
+        return -1;
+    }
+
+    audio->length = pcm_size / (bytes * channels);
+    audio->samples = malloc(audio->length * sizeof(int16_t) + 1);
+    for (uint32_t i = 0; i < audio->length; i++) {
+        int32_t sum = 0;
+        for (int c = 0; c < channels; c++)
+            sum += pcm_to_16(pcm + (i * channels + c) * bytes, bytes);
+        audio->samples[i] = sum / channels;
+    }
+
+    free(data);
+    return 0;
+}
+
+void wav_free(WavAudio *audio) {
+    free(audio->samples);
+    audio->samples = NULL;
+    audio->length = 0;
+}
+
+// Abre um WAV mono de 16 bits para escrita incremental
+FILE *wav_write_begin(const char *path, uint32_t sample_rate) {
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return NULL;
+
+    fwrite("RIFF", 1, 4, file);
+    write_u32(file, 36);
+    fwrite("WAVEfmt ", 1, 8, file);
+    write_u32(file, 16);
+    write_u16(file, 1);               // PCM
+    write_u16(file, 1);               // Mono
+    write_u32(file, sample_rate);
+    write_u32(file, sample_rate * 2); // Bytes por segundo
+    write_u16(file, 2);               // Bytes por quadro
+    write_u16(file, 16);
+    fwrite("data", 1, 4, file);
+    write_u32(file, 0);
+    return file;
+}
+
+void wav_write_samples(FILE *file, const int16_t *samples, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++)
+        write_u16(file, (uint16_t)samples[i]);
+}
+
+// Corrige os tamanhos no cabeçalho e fecha o arquivo
+void wav_write_end(FILE *file) {
+    long size = ftell(file);
+
+    fseek(file, 4, SEEK_SET);
+    write_u32(file, size - 8);
+    fseek(file, 40, SEEK_SET);
+    write_u32(file, size - 44);
+    fclose(file);
+}
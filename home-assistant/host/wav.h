@@ -0,0 +1,21 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef wav_inc_h
+#define wav_inc_h
+
+// Leitura e escrita de arquivos WAV PCM para as ferramentas de host
+
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t length;   // Amostras (mono)
+    int16_t *samples;  // Canais misturados em mono, 16 bits
+} WavAudio;
+
+extern int wav_read(const char *path, WavAudio *audio);
+extern void wav_free(WavAudio *audio);
+extern FILE *wav_write_begin(const char *path, uint32_t sample_rate);
+extern void wav_write_samples(FILE *file, const int16_t *samples, uint32_t count);
+extern void wav_write_end(FILE *file);
+
+#endif
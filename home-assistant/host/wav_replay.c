@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "audio_config.h"
+#include "audio_dsp.h"
+#include "sound_detector.h"
+#include "wav.h"
+
+// Reproduz gravações WAV pelo mesmo caminho de detecção do firmware
+// (remoção de DC + sound_detector em blocos de MIC_BLOCK_SIZE) e compara os
+// eventos com marcações feitas à mão.
+//
+// Marcações: <arquivo>.txt ao lado do WAV, uma por linha, no formato
+// "<segundos> [tipo [classe]]" ou no formato de faixa de rótulos do Audacity
+// ("<início>\t<fim>\t<tipo>[ classe]"). Tipos: double_clap (padrão),
+// loud_noise, onset. Com a classe espectral (impulse, tonal, high,
+// broadband), a detecção só casa se o detector der a mesma classe.
+
+#define MAX_LABELS 1024
+
+static const char *event_names[] = {"onset", "double_clap", "loud_noise", "keyword", "learned", "recorded",
+                                     "rhythm", "rhythm_recorded"};
+static const char *class_names[] = {"?", "impulse", "tonal", "high", "broadband"};
+
+typedef struct {
+    uint32_t sample;
+    SoundEventType type;
+    SoundClass sound_class;  // SOUND_CLASS_UNKNOWN: qualquer classe
+    bool matched;
+} Label;
+
+typedef struct {
+    uint32_t true_pos, false_pos, false_neg;
+    double latency_sum, latency_max;
+    double samples, seconds;
+} Totals;
+
+typedef struct {
+    SoundDetectorConfig config;
+    double tolerance_ms;
+    bool timeline;
+    bool onsets;
+    double min_precision, min_recall;
+} Options;
+
+static int parse_type(const char *name, SoundEventType *type) {
+    for (int i = 0; i < 3; i++) {
+        if (!strcmp(name, event_names[i])) {
+            *type = (SoundEventType)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int parse_class(const char *name, SoundClass *sound_class) {
+    for (int i = 1; i < (int)(sizeof(class_names) / sizeof(class_names[0])); i++) {
+        if (!strcmp(name, class_names[i])) {
+            *sound_class = (SoundClass)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Lê as marcações do arquivo ao lado do WAV; retorna quantas (-1 se não há)
+static int read_labels(const char *wav_path, uint32_t rate, Label *labels) {
+    char path[1024];
+    const char *dot = strrchr(wav_path, '.');
+    int base = dot ? (int)(dot - wav_path) : (int)strlen(wav_path);
+    snprintf(path, sizeof(path), "%.*s.txt", base, wav_path);
+
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return -1;
+
+    char line[256];
+    int count = 0;
+    while (fgets(line, sizeof(line), file) && count < MAX_LABELS) {
+        double start, end;
+        char name[64] = "double_clap", class_name[64] = "";
+
+        if (line[0] == '#' || sscanf(line, "%lf", &start) != 1)
+            continue;
+        if (sscanf(line, "%lf %lf %63s %63s", &start, &end, name, class_name) < 3)
+            sscanf(line, "%lf %63s %63s", &start, name, class_name);
+
+        SoundEventType type;
+        if (parse_type(name, &type) < 0) {
+            fprintf(stderr, "%s: tipo desconhecido '%s'\n", path, name);
+            continue;
+        }
+        SoundClass sound_class = SOUND_CLASS_UNKNOWN;
+        if (class_name[0] && parse_class(class_name, &sound_class) < 0) {
+            fprintf(stderr, "%s: classe desconhecida '%s'\n", path, class_name);
+            continue;
+        }
+        labels[count++] = (Label){(uint32_t)(start * rate + 0.5), type, sound_class, false};
+    }
+    fclose(file);
+    return count;
+}
+
+// Reamostra linearmente para a taxa do firmware e converte para contagens do ADC
+static uint16_t *to_adc_stream(const WavAudio *audio, uint32_t rate, uint32_t *length) {
+    uint64_t n = (uint64_t)audio->length * rate / audio->sample_rate;
+    n -= n % MIC_BLOCK_SIZE;
+    uint16_t *adc = malloc(n * sizeof(uint16_t) + 1);
+
+    for (uint64_t i = 0; i < n; i++) {
+        double pos = (double)i * audio->sample_rate / rate;
+        uint32_t j = (uint32_t)pos;
+        double frac = pos - j;
+        double s = audio->samples[j];
+        if (j + 1 < audio->length)
+            s += (audio->samples[j + 1] - s) * frac;
+
+        // 16 bits com sinal -> 12 bits em torno do nível de repouso do microfone
+        int v = OFFSET + (int)(s / 16);
+        adc[i] = v < 0 ? 0 : v > 4095 ? 4095 : v;
+    }
+    *length = (uint32_t)n;
+    return adc;
+}
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int replay_file(const char *path, const Options *options, Totals *totals) {
+    WavAudio audio;
+    if (wav_read(path, &audio) < 0) {
+        fprintf(stderr, "%s: WAV PCM inválido\n", path);
+        return -1;
+    }
+
+    const uint32_t rate = options->config.sample_rate;
+    uint32_t length;
+    uint16_t *adc = to_adc_stream(&audio, rate, &length);
+    wav_free(&audio);
+
+    static Label labels[MAX_LABELS];
+    int label_count = read_labels(path, rate, labels);
+
+    // Mesmo caminho do firmware: DC removido por bloco e detector em fluxo
+    static int16_t block[MIC_BLOCK_SIZE] __attribute__((aligned(4)));
+    static SoundEvent detected[1 << 16];
+    SoundEvent events[SOUND_MAX_EVENTS];
+    SoundDetector detector;
+    DcFilter dc;
+    int detected_count = 0;
+
+    sound_detector_init(&detector, &options->config);
+    dsp_dc_init(&dc, OFFSET);
+
+    double start = now_seconds();
+    for (uint32_t s = 0; s < length; s += MIC_BLOCK_SIZE) {
+        dsp_dc_remove(&dc, adc + s, block, MIC_BLOCK_SIZE);
+        int n = sound_detector_process(&detector, block, MIC_BLOCK_SIZE, s, events, SOUND_MAX_EVENTS);
+        for (int i = 0; i < n && detected_count < (int)(sizeof(detected) / sizeof(detected[0])); i++)
+            detected[detected_count++] = events[i];
+    }
+    double elapsed = now_seconds() - start;
+    free(adc);
+
+    printf("%s: %.2f s, %d eventos, %.0f amostras/s (%.0fx tempo real)\n", path,
+           (double)length / rate, detected_count, length / elapsed, length / elapsed / rate);
+    if (options->config.adaptive)
+        printf("  fundo %u +- %u, limiares palma %u, som alto %u\n", dsp_floor_mean(&detector.floor),
+               dsp_floor_deviation(&detector.floor), detector.clap_level, detector.noise_level);
+
+    // Casa cada detecção com a marcação mais próxima do mesmo tipo (e da
+    // mesma classe, se marcada e com a classificação espectral ligada)
+    const uint32_t tolerance = (uint32_t)(options->tolerance_ms * rate / 1000);
+    Totals file = {0};
+    for (int i = 0; i < detected_count; i++) {
+        const SoundEvent *e = &detected[i];
+        const char *verdict = "";
+
+        if (e->type == SOUND_EVENT_ONSET && !options->onsets)
+            continue;
+
+        if (label_count >= 0) {
+            int best = -1;
+            uint32_t best_dist = tolerance + 1;
+            for (int l = 0; l < label_count; l++) {
+                if (labels[l].matched || labels[l].type != e->type)
+                    continue;
+                if (labels[l].sound_class != SOUND_CLASS_UNKNOWN && options->config.use_spectrum &&
+                    labels[l].sound_class != e->sound_class)
+                    continue;
+                uint32_t dist = e->sample > labels[l].sample ? e->sample - labels[l].sample
+                                                              : labels[l].sample - e->sample;
+                if (dist < best_dist) {
+                    best = l;
+                    best_dist = dist;
+                }
+            }
+            if (best >= 0) {
+                double latency = ((double)e->sample - labels[best].sample) * 1000.0 / rate;
+                labels[best].matched = true;
+                file.true_pos++;
+                file.latency_sum += latency;
+                if (latency > file.latency_max)
+                    file.latency_max = latency;
+                verdict = "ok";
+            } else {
+                file.false_pos++;
+                verdict = "FALSO POSITIVO";
+            }
+        }
+
+        if (options->timeline)
+            printf("  %9.3f s  %-12s nivel %5u  %-9s %s\n", (double)e->sample / rate,
+                   event_names[e->type], e->level, class_names[e->sound_class], verdict);
+    }
+
+    for (int l = 0; l < label_count; l++) {
+        if (labels[l].matched || (labels[l].type == SOUND_EVENT_ONSET && !options->onsets))
+            continue;
+        file.false_neg++;
+        if (options->timeline)
+            printf("  %9.3f s  %-12s             %-9s PERDIDO\n", (double)labels[l].sample / rate,
+                   event_names[labels[l].type], labels[l].sound_class ? class_names[labels[l].sound_class] : "");
+    }
+
+    if (label_count < 0)
+        printf("  (sem marcações)\n");
+
+    totals->true_pos += file.true_pos;
+    totals->false_pos += file.false_pos;
+    totals->false_neg += file.false_neg;
+    totals->latency_sum += file.latency_sum;
+    if (file.latency_max > totals->latency_max)
+        totals->latency_max = file.latency_max;
+    totals->samples += length;
+    totals->seconds += elapsed;
+    return 0;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+        "uso: %s [opções] arquivo.wav...\n"
+        "  --tolerance MS      janela para casar detecção e marcação (padrão 100)\n"
+        "  --clap-level N      limiar mínimo da palma em contagens do ADC (padrão %d)\n"
+        "  --noise-level N     limiar mínimo do som alto (padrão %d)\n"
+        "  --fixed             limiares fixos, sem calibrar pelo fundo\n"
+        "  --onset-ratio N     início quando rápida > lenta * N / 4 (padrão 12)\n"
+        "  --gap MIN MAX       janela entre palmas em ms (padrão 200 1000)\n"
+        "  --no-spectrum       desliga a classificação espectral\n"
+        "  --onsets            também avalia eventos de início\n"
+        "  --quiet             sem linha do tempo por arquivo\n"
+        "  --min-precision P   falha (código 1) se a precisão total < P\n"
+        "  --min-recall R      falha (código 1) se a revocação total < R\n",
+        name, CLAP_THRESHOLD, NOISE_THRESHOLD);
+}
+
+int main(int argc, char **argv) {
+    Options options = {.tolerance_ms = 100, .timeline = true};
+    sound_detector_default_config(&options.config, MIC_SAMPLE_RATE);
+
+    int first_file = argc;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (!strcmp(arg, "--tolerance") && has_value)
+            options.tolerance_ms = atof(argv[++i]);
+        else if (!strcmp(arg, "--clap-level") && has_value)
+            options.config.clap_level = atoi(argv[++i]);
+        else if (!strcmp(arg, "--noise-level") && has_value)
+            options.config.noise_level = atoi(argv[++i]);
+        else if (!strcmp(arg, "--onset-ratio") && has_value)
+            options.config.onset_ratio = atoi(argv[++i]);
+        else if (!strcmp(arg, "--gap") && i + 2 < argc) {
+            options.config.gap_min_ms = atoi(argv[++i]);
+            options.config.gap_max_ms = atoi(argv[++i]);
+        }
+        else if (!strcmp(arg, "--fixed"))
+            options.config.adaptive = false;
+        else if (!strcmp(arg, "--no-spectrum"))
+            options.config.use_spectrum = false;
+        else if (!strcmp(arg, "--onsets"))
+            options.onsets = true;
+        else if (!strcmp(arg, "--quiet"))
+            options.timeline = false;
+        else if (!strcmp(arg, "--min-precision") && has_value)
+            options.min_precision = atof(argv[++i]);
+        else if (!strcmp(arg, "--min-recall") && has_value)
+            options.min_recall = atof(argv[++i]);
+        else if (arg[0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            first_file = i;
+            break;
+        }
+    }
+
+    if (first_file >= argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    Totals totals = {0};
+    int failures = 0;
+    for (int i = first_file; i < argc; i++)
+        failures += replay_file(argv[i], &options, &totals) < 0;
+
+    uint32_t tp = totals.true_pos;
+    double precision = tp + totals.false_pos ? (double)tp / (tp + totals.false_pos) : 1.0;
+    double recall = tp + totals.false_neg ? (double)tp / (tp + totals.false_neg) : 1.0;
+
+    printf("\nTotal: %u acertos, %u falsos positivos, %u perdidos\n",
+           tp, totals.false_pos, totals.false_neg);
+    printf("Precisão %.3f  revocação %.3f\n", precision, recall);
+    if (tp)
+        printf("Latência média %.1f ms, máxima %.1f ms\n", totals.latency_sum / tp, totals.latency_max);
+    if (totals.seconds > 0)
+        printf("Velocidade: %.0f amostras/s\n", totals.samples / totals.seconds);
+
+    if (failures || precision < options.min_precision || recall < options.min_recall)
+        return 1;
+    return 0;
+}
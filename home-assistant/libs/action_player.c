@@ -0,0 +1,124 @@
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "action_player.h"
+
+// Toca padrões de buzzer e LEDs por alarme de hardware, sem bloquear o laço
+// principal. O buzzer é atualizado na própria interrupção; a cor da matriz é
+// publicada e escrita pelo laço principal em action_player_poll(), já que a
+// escrita nos NeoPixels espera o PIO e não deve rodar em interrupção.
+
+static uint buzzer;
+static alarm_id_t alarm = 0;
+static const ActionPattern *volatile pattern = NULL;
+static volatile uint8_t step = 0;
+static volatile uint16_t repeats_left = 0;   // Repetições após a atual
+
+static uint8_t idle_color[3];                // Cor da matriz sem padrão ativo
+static uint8_t frame_color[3];               // Última cor publicada
+static volatile bool frame_dirty = false;
+
+static void publish(const uint8_t color[3]) {
+    frame_color[0] = color[0];
+    frame_color[1] = color[1];
+    frame_color[2] = color[2];
+    frame_dirty = true;
+}
+
+// Aplica o passo atual e devolve sua duração
+static uint32_t apply_step() {
+    const ActionStep *s = &pattern->steps[step];
+    pwm_set_gpio_level(buzzer, s->buzzer_level);
+    publish(s->color);
+    return s->duration_ms;
+}
+
+static void finish() {
+    pattern = NULL;
+    alarm = 0;
+    pwm_set_gpio_level(buzzer, 0);
+    publish(idle_color);
+}
+
+// Avança um passo; o valor negativo reagenda a partir do instante previsto
+// anterior, sem acumular atraso entre os passos
+static int64_t step_callback(alarm_id_t id, void *user_data) {
+    if (pattern == NULL)
+        return 0;
+
+    if (++step >= pattern->length) {
+        step = 0;
+        if (repeats_left == 0) {
+            finish();
+            return 0;
+        }
+        repeats_left--;
+    }
+    return -(int64_t)apply_step() * 1000;
+}
+
+void action_player_init(uint buzzer_pin) {
+    buzzer = buzzer_pin;
+    action_player_cancel();
+    idle_color[0] = idle_color[1] = idle_color[2] = 0;
+    frame_dirty = false;
+}
+
+// Dispara um padrão repeats vezes. Em ACTION_EXTEND, se o mesmo padrão já está
+// tocando, só acrescenta repetições (ex.: o ruído continua, o alarme se estende)
+void action_player_trigger(const ActionPattern *p, uint repeats, ActionTrigger mode) {
+    if (p == NULL || p->length == 0 || repeats == 0)
+        return;
+
+    uint32_t irq = save_and_disable_interrupts();
+    if (mode == ACTION_EXTEND && pattern == p) {
+        uint32_t total = repeats_left + repeats;
+        repeats_left = total > ACTION_MAX_REPEATS ? ACTION_MAX_REPEATS : total;
+        restore_interrupts(irq);
+        return;
+    }
+    restore_interrupts(irq);
+
+    action_player_cancel();
+    pattern = p;
+    step = 0;
+    repeats_left = (repeats > ACTION_MAX_REPEATS ? ACTION_MAX_REPEATS : repeats) - 1;
+    alarm = add_alarm_in_ms(apply_step(), step_callback, NULL, true);
+}
+
+// Interrompe o padrão, silencia o buzzer e volta à cor de repouso
+void action_player_cancel() {
+    if (alarm > 0)
+        cancel_alarm(alarm);
+    finish();
+}
+
+bool action_player_active() {
+    return pattern != NULL;
+}
+
+const ActionPattern *action_player_pattern() {
+    return pattern;
+}
+
+// Cor da matriz quando nenhum padrão está tocando (ex.: luz ligada por palmas)
+void action_player_set_idle(const uint8_t color[3]) {
+    idle_color[0] = color[0];
+    idle_color[1] = color[1];
+    idle_color[2] = color[2];
+    if (pattern == NULL)
+        publish(idle_color);
+}
+
+// Chamado pelo laço principal: true (com a cor) se a matriz precisa mudar
+bool action_player_poll(uint8_t color[3]) {
+    if (!frame_dirty)
+        return false;
+
+    uint32_t irq = save_and_disable_interrupts();
+    color[0] = frame_color[0];
+    color[1] = frame_color[1];
+    color[2] = frame_color[2];
+    frame_dirty = false;
+    restore_interrupts(irq);
+    return true;
+}
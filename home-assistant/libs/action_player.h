@@ -0,0 +1,33 @@
+#include "pico/stdlib.h"
+
+#ifndef action_player_inc_h
+#define action_player_inc_h
+
+#define ACTION_MAX_REPEATS 255
+
+// Um passo do padrão: nível do buzzer e cor da matriz por duration_ms
+typedef struct {
+    uint16_t duration_ms;
+    uint16_t buzzer_level;     // Nível PWM do buzzer (0 = silêncio)
+    uint8_t color[3];          // Cor de todos os LEDs da matriz
+} ActionStep;
+
+typedef struct {
+    const ActionStep *steps;
+    uint8_t length;
+} ActionPattern;
+
+typedef enum {
+    ACTION_RESTART,            // Recomeça o padrão do primeiro passo
+    ACTION_EXTEND              // Mesmo padrão em andamento: soma as repetições
+} ActionTrigger;
+
+extern void action_player_init(uint buzzer_pin);
+extern void action_player_trigger(const ActionPattern *pattern, uint repeats, ActionTrigger mode);
+extern void action_player_cancel();
+extern bool action_player_active();
+extern const ActionPattern *action_player_pattern();
+extern void action_player_set_idle(const uint8_t color[3]);
+extern bool action_player_poll(uint8_t color[3]);
+
+#endif
@@ -0,0 +1,218 @@
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "adc_service.h"
+
+// Blocos intercalados preenchidos pelo DMA: MIC_BLOCK_SIZE quadros com uma
+// amostra de cada canal ativo, na ordem crescente dos canais
+static uint16_t raw[2][MIC_BLOCK_SIZE * ADC_SERVICE_CHANNELS] __attribute__((aligned(4)));
+
+// Buffer circular do canal de fluxo, um bloco por vez (alinhado para
+// leituras de 32 bits nos kernels de áudio)
+static uint16_t ring[MIC_RING_BLOCKS][MIC_BLOCK_SIZE] __attribute__((aligned(4)));
+
+// Dois canais de DMA encadeados em pingue-pongue: enquanto a interrupção
+// separa um bloco, o outro canal já está preenchendo o seguinte, sem lacunas
+static int dma_chan[2] = {-1, -1};
+
+static uint8_t channel_count = 0;            // Canais na máscara
+static uint8_t channel_of[ADC_SERVICE_CHANNELS]; // Canal do ADC de cada posição no quadro
+static uint8_t stream_slot = 0;              // Posição do canal de fluxo no quadro
+
+static volatile uint32_t filtered[ADC_SERVICE_CHANNELS]; // Valores lentos, 12 bits em Q4
+static volatile uint32_t updates = 0;        // Blocos separados (contador livre)
+
+static volatile uint32_t blocks_written = 0; // Blocos completos (contador livre)
+static uint32_t blocks_read = 0;             // Blocos já entregues ao consumidor
+static volatile uint32_t overruns = 0;       // Blocos descartados por atraso do consumidor
+static bool sampling = false;
+
+// Separa um bloco intercalado: o canal de fluxo vai para o buffer circular e
+// cada canal tem a média do bloco (+ 6 bits de sobreamostragem) filtrada
+static void deinterleave(const uint16_t *frames) {
+    uint16_t *out = ring[blocks_written % MIC_RING_BLOCKS];
+    uint32_t sums[ADC_SERVICE_CHANNELS] = {0};
+    const int n = channel_count;
+
+    for (int i = 0; i < MIC_BLOCK_SIZE; i++, frames += n) {
+        for (int c = 0; c < n; c++)
+            sums[c] += frames[c];
+        out[i] = frames[stream_slot];
+    }
+
+    for (int c = 0; c < n; c++) {
+        uint32_t mean_q4 = (sums[c] << 4) / MIC_BLOCK_SIZE;
+        uint32_t old = filtered[channel_of[c]];
+        filtered[channel_of[c]] = old + (((int32_t)(mean_q4 - old)) >> ADC_FILTER_SHIFT);
+    }
+    updates++;
+}
+
+// Interrupção de fim de bloco: separa o bloco e rearma o canal no mesmo buffer
+static void adc_service_dma_handler() {
+    for (int i = 0; i < 2; i++) {
+        if (dma_chan[i] < 0 || !dma_channel_get_irq0_status(dma_chan[i]))
+            continue;
+
+        dma_channel_acknowledge_irq0(dma_chan[i]);
+        deinterleave(raw[i]);
+        dma_channel_set_write_addr(dma_chan[i], raw[i], false);
+        blocks_written++;
+        __sev(); // Acorda consumidores em __wfe()
+    }
+}
+
+// Configura o ADC em round-robin sobre channel_mask, cada canal a channel_rate,
+// e reserva os canais de DMA. stream_channel deve estar na máscara.
+void adc_service_init(uint8_t channel_mask, uint stream_channel, uint channel_rate) {
+    adc_init();
+
+    channel_count = 0;
+    for (uint c = 0; c < ADC_SERVICE_CHANNELS; c++) {
+        if (!(channel_mask & (1u << c)))
+            continue;
+        adc_gpio_init(26 + c);
+        if (c == stream_channel)
+            stream_slot = channel_count;
+        channel_of[channel_count++] = c;
+        filtered[c] = 2048 << 4;
+    }
+
+    // Cada conversão gera um pedido de DMA; resultados de 12 bits sem deslocamento
+    adc_fifo_setup(true, true, 1, false, false);
+
+    // Conversão dura (1 + div) ciclos do clock de 48 MHz do ADC, dividida entre os canais
+    adc_set_clkdiv(48000000.0f / (channel_rate * channel_count) - 1);
+
+    if (dma_chan[0] < 0) {
+        dma_chan[0] = dma_claim_unused_channel(true);
+        dma_chan[1] = dma_claim_unused_channel(true);
+        irq_add_shared_handler(DMA_IRQ_0, adc_service_dma_handler,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    }
+
+    // A interrupção é atendida pelo núcleo que inicializa o serviço
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    for (int i = 0; i < 2; i++) {
+        dma_channel_config config = dma_channel_get_default_config(dma_chan[i]);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+        channel_config_set_read_increment(&config, false);
+        channel_config_set_write_increment(&config, true);
+        channel_config_set_dreq(&config, DREQ_ADC);
+        channel_config_set_chain_to(&config, dma_chan[1 - i]);
+        dma_channel_configure(dma_chan[i], &config, raw[i], &adc_hw->fifo,
+                              MIC_BLOCK_SIZE * channel_count, false);
+    }
+}
+
+// Inicia a amostragem contínua
+void adc_service_start() {
+    if (sampling)
+        return;
+
+    blocks_written = 0;
+    blocks_read = 0;
+    overruns = 0;
+
+    adc_run(false);
+    adc_fifo_setup(true, true, 1, false, false);  // adc_service_stop desliga o FIFO
+    adc_fifo_drain();
+
+    // O round-robin parte do menor canal, para que cada quadro siga a ordem crescente
+    uint mask = 0;
+    for (int c = 0; c < channel_count; c++)
+        mask |= 1u << channel_of[c];
+    adc_select_input(channel_of[0]);
+    adc_set_round_robin(channel_count > 1 ? mask : 0);
+
+    dma_channel_set_write_addr(dma_chan[0], raw[0], false);
+    dma_channel_set_write_addr(dma_chan[1], raw[1], false);
+    dma_channel_set_irq0_enabled(dma_chan[0], true);
+    dma_channel_set_irq0_enabled(dma_chan[1], true);
+    dma_channel_start(dma_chan[0]);
+
+    adc_run(true);
+    sampling = true;
+}
+
+// Para a amostragem e devolve o ADC ao modo de leitura única (adc_read)
+void adc_service_stop() {
+    if (!sampling)
+        return;
+
+    adc_run(false);
+    adc_set_round_robin(0);
+
+    dma_channel_set_irq0_enabled(dma_chan[0], false);
+    dma_channel_set_irq0_enabled(dma_chan[1], false);
+
+    // O encadeamento pode religar o outro canal durante o abort, então repete
+    while (dma_channel_is_busy(dma_chan[0]) || dma_channel_is_busy(dma_chan[1])) {
+        dma_channel_abort(dma_chan[0]);
+        dma_channel_abort(dma_chan[1]);
+    }
+    dma_channel_acknowledge_irq0(dma_chan[0]);
+    dma_channel_acknowledge_irq0(dma_chan[1]);
+
+    adc_fifo_setup(false, false, 0, false, false);
+    adc_fifo_drain();
+    sampling = false;
+}
+
+// Último valor filtrado do canal (12 bits), atualizado a cada bloco
+uint16_t adc_service_value(uint channel) {
+    return filtered[channel] >> 4;
+}
+
+// Blocos separados desde o início; muda quando há valores novos
+uint32_t adc_service_updates() {
+    return updates;
+}
+
+// Descarta os blocos pendentes: o próximo bloco entregue é o próximo a completar
+void adc_service_flush() {
+    blocks_read = blocks_written;
+}
+
+// Número de blocos completos aguardando leitura
+uint adc_service_available() {
+    uint32_t pending = blocks_written - blocks_read;
+
+    // Preserva o bloco que o consumidor ainda processa; descarta os mais antigos
+    if (pending > MIC_RING_BLOCKS - 2) {
+        overruns += pending - (MIC_RING_BLOCKS - 2);
+        blocks_read = blocks_written - (MIC_RING_BLOCKS - 2);
+        pending = MIC_RING_BLOCKS - 2;
+    }
+    return pending;
+}
+
+// Retorna o próximo bloco completo ou NULL se nenhum estiver pronto.
+// O ponteiro permanece válido até a interrupção dar a volta no buffer circular.
+const uint16_t *adc_service_next_block() {
+    if (adc_service_available() == 0)
+        return NULL;
+
+    return ring[blocks_read++ % MIC_RING_BLOCKS];
+}
+
+// Espera (dormindo até a próxima interrupção) pelo próximo bloco completo
+const uint16_t *adc_service_wait_block() {
+    const uint16_t *block;
+
+    while ((block = adc_service_next_block()) == NULL)
+        __wfe();
+
+    return block;
+}
+
+// Total de blocos entregues desde o início (base de tempo do fluxo)
+uint32_t adc_service_blocks_read() {
+    return blocks_read;
+}
+
+uint32_t adc_service_overruns() {
+    return overruns;
+}
@@ -0,0 +1,30 @@
+#include "pico/stdlib.h"
+#include "audio_config.h"
+
+#ifndef adc_service_inc_h
+#define adc_service_inc_h
+
+#define ADC_SERVICE_CHANNELS 3     // Canais 0 e 1 (joystick) e 2 (microfone)
+#define ADC_FILTER_SHIFT 2         // Passa-baixa dos valores lentos: 1/4 por bloco
+
+// Serviço único do ADC: o modo round-robin converte os canais da máscara em
+// sequência, o DMA copia o FIFO em blocos intercalados e a interrupção separa
+// cada canal. O canal de fluxo (microfone) é entregue em blocos completos de
+// MIC_BLOCK_SIZE amostras; todos os canais têm ainda um valor sobreamostrado
+// (média do bloco) e filtrado, lido em tempo constante.
+
+extern void adc_service_init(uint8_t channel_mask, uint stream_channel, uint channel_rate);
+extern void adc_service_start();
+extern void adc_service_stop();
+extern uint16_t adc_service_value(uint channel);
+extern uint32_t adc_service_updates();
+
+// Fluxo do canal de áudio
+extern void adc_service_flush();
+extern uint adc_service_available();
+extern const uint16_t *adc_service_next_block();
+extern const uint16_t *adc_service_wait_block();
+extern uint32_t adc_service_blocks_read();
+extern uint32_t adc_service_overruns();
+
+#endif
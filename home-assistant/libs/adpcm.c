@@ -0,0 +1,127 @@
+#include "adpcm.h"
+
+static const int16_t step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+};
+
+static const int8_t index_table[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+void adpcm_init(AdpcmState *state) {
+    state->predictor = 0;
+    state->index = 0;
+}
+
+// Aplica um código de 4 bits ao estado (mesma conta no codificador e no
+// decodificador, para os dois seguirem juntos)
+static int16_t apply_code(AdpcmState *state, uint8_t code) {
+    int32_t step = step_table[state->index];
+    int32_t diff = step >> 3;
+
+    if (code & 4) diff += step;
+    if (code & 2) diff += step >> 1;
+    if (code & 1) diff += step >> 2;
+
+    int32_t predictor = state->predictor + (code & 8 ? -diff : diff);
+    state->predictor = predictor > 32767 ? 32767 : predictor < -32768 ? -32768 : predictor;
+
+    int index = state->index + index_table[code & 7];
+    state->index = index < 0 ? 0 : index > 88 ? 88 : index;
+    return state->predictor;
+}
+
+static uint8_t encode_sample(AdpcmState *state, int16_t sample) {
+    int32_t step = step_table[state->index];
+    int32_t diff = sample - state->predictor;
+    uint8_t code = 0;
+
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+    }
+    if (diff >= step >> 1) {
+        code |= 2;
+        diff -= step >> 1;
+    }
+    if (diff >= step >> 2)
+        code |= 1;
+
+    apply_code(state, code);
+    return code;
+}
+
+// Codifica n amostras (n par) em n / 2 bytes
+void adpcm_encode(AdpcmState *state, const int16_t *in, uint8_t *out, int n) {
+    for (int i = 0; i < n; i += 2) {
+        uint8_t low = encode_sample(state, in[i]);
+        uint8_t high = encode_sample(state, in[i + 1]);
+        out[i / 2] = low | (high << 4);
+    }
+}
+
+void adpcm_decode(AdpcmState *state, const uint8_t *in, int16_t *out, int n) {
+    for (int i = 0; i < n; i += 2) {
+        out[i] = apply_code(state, in[i / 2] & 0x0F);
+        out[i + 1] = apply_code(state, in[i / 2] >> 4);
+    }
+}
+
+// CRC-16/CCITT (polinômio 0x1021, início 0xFFFF), bit a bit: ~1 ms por
+// segundo de áudio no RP2040, sem tabela na RAM
+uint16_t adpcm_crc16(const uint8_t *data, int n) {
+    uint16_t crc = 0xFFFF;
+
+    for (int i = 0; i < n; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+// Monta um quadro de ADPCM_FRAME_BYTES com ADPCM_FRAME_SAMPLES amostras,
+// continuando do estado do quadro anterior
+void adpcm_frame_pack(uint8_t *frame, uint16_t seq, uint16_t rate, AdpcmState *state,
+                      const int16_t *samples) {
+    frame[0] = ADPCM_MAGIC_0;
+    frame[1] = ADPCM_MAGIC_1;
+    put16(frame + 2, seq);
+    put16(frame + 4, rate);
+    put16(frame + 6, (uint16_t)state->predictor);
+    frame[8] = state->index;
+    frame[9] = 0;
+    adpcm_encode(state, samples, frame + ADPCM_HEADER_BYTES, ADPCM_FRAME_SAMPLES);
+    put16(frame + ADPCM_FRAME_BYTES - 2, adpcm_crc16(frame + 2, ADPCM_FRAME_BYTES - 4));
+}
+
+// Confere marcador e CRC e decodifica; false se o quadro está corrompido
+bool adpcm_frame_unpack(const uint8_t *frame, uint16_t *seq, uint16_t *rate, int16_t *samples) {
+    if (frame[0] != ADPCM_MAGIC_0 || frame[1] != ADPCM_MAGIC_1 || frame[8] > 88)
+        return false;
+    if (adpcm_crc16(frame + 2, ADPCM_FRAME_BYTES - 4) != get16(frame + ADPCM_FRAME_BYTES - 2))
+        return false;
+
+    AdpcmState state = {(int16_t)get16(frame + 6), frame[8]};
+    *seq = get16(frame + 2);
+    *rate = get16(frame + 4);
+    adpcm_decode(&state, frame + ADPCM_HEADER_BYTES, samples, ADPCM_FRAME_SAMPLES);
+    return true;
+}
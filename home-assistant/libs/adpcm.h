@@ -0,0 +1,40 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef adpcm_inc_h
+#define adpcm_inc_h
+
+// IMA-ADPCM (4 bits por amostra) e os quadros da captura de áudio pela USB.
+// Cada quadro leva o estado do codificador no cabeçalho, então decodifica
+// sozinho: um quadro perdido não estraga os seguintes.
+//
+// Quadro (little-endian):
+//   0  0xA5 0x5A        marcador
+//   2  uint16 seq       número de sequência (lacunas = quadros perdidos)
+//   4  uint16 rate      taxa de amostragem em Hz
+//   6  int16 predictor  estado do codificador no início do quadro
+//   8  uint8 index
+//   9  uint8 0          reservado
+//   10 payload          ADPCM_FRAME_SAMPLES amostras, nibble baixo primeiro
+//   .. uint16 crc       CRC-16/CCITT dos bytes 2 até o fim do payload
+
+#define ADPCM_FRAME_SAMPLES 256  // Amostras por quadro (16 ms a 16 kHz)
+#define ADPCM_HEADER_BYTES 10
+#define ADPCM_FRAME_BYTES (ADPCM_HEADER_BYTES + ADPCM_FRAME_SAMPLES / 2 + 2)
+#define ADPCM_MAGIC_0 0xA5
+#define ADPCM_MAGIC_1 0x5A
+
+typedef struct {
+    int16_t predictor;
+    uint8_t index;   // Posição na tabela de passos (0 a 88)
+} AdpcmState;
+
+extern void adpcm_init(AdpcmState *state);
+extern void adpcm_encode(AdpcmState *state, const int16_t *in, uint8_t *out, int n);
+extern void adpcm_decode(AdpcmState *state, const uint8_t *in, int16_t *out, int n);
+extern uint16_t adpcm_crc16(const uint8_t *data, int n);
+extern void adpcm_frame_pack(uint8_t *frame, uint16_t seq, uint16_t rate, AdpcmState *state,
+                             const int16_t *samples);
+extern bool adpcm_frame_unpack(const uint8_t *frame, uint16_t *seq, uint16_t *rate, int16_t *samples);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef audio_config_inc_h
+#define audio_config_inc_h
+
+// Parâmetros do fluxo do microfone compartilhados pelo firmware e pelas
+// ferramentas de host, para que ambos processem blocos idênticos
+
+#define MIC_SAMPLE_RATE 16000 // Taxa de amostragem padrão do microfone (Hz)
+#define MIC_BLOCK_SIZE 64     // Amostras por bloco (4 ms a 16 kHz)
+#define MIC_RING_BLOCKS 16    // Blocos no buffer circular (potência de 2)
+#define OFFSET 2048           // ADC Pico W vai de 0 a 4095, offset no meio
+
+// Converte uma duração em milissegundos para número de blocos (mínimo 1)
+#define MIC_BLOCKS_FOR_MS(ms, rate) \
+    ((((ms) * (rate)) / 1000 + MIC_BLOCK_SIZE - 1) / MIC_BLOCK_SIZE)
+
+#endif
@@ -0,0 +1,172 @@
+#include "audio_dsp.h"
+
+// Módulo de um inteiro sem desvio condicional
+static inline int32_t dsp_abs(int32_t x) {
+    int32_t mask = x >> 31;
+    return (x ^ mask) - mask;
+}
+
+// Passo do removedor de DC: y = x - média, média += (x - média) / 2^DSP_DC_SHIFT
+#define DC_STEP(x, y) do {                              \
+        int32_t _x = (int32_t)(x) << 15;                \
+        dc += (_x - dc) >> DSP_DC_SHIFT;                \
+        (y) = (int16_t)((_x - dc) >> 15);               \
+    } while (0)
+
+// Inicia a média de DC no nível de repouso esperado (ex.: 2048)
+void dsp_dc_init(DcFilter *filter, uint16_t bias) {
+    filter->dc = (int32_t)bias << 15;
+}
+
+// Remove o nível DC de um bloco do ADC (passa-altas de um polo)
+void dsp_dc_remove(DcFilter *filter, const uint16_t *in, int16_t *out, int n) {
+    const uint32_t *in32 = (const uint32_t *)in;
+    uint32_t *out32 = (uint32_t *)out;
+    int32_t dc = filter->dc;
+    int16_t y0, y1, y2, y3;
+
+    for (int i = 0; i < n / 4; i++) {
+        uint32_t a = in32[2 * i];
+        uint32_t b = in32[2 * i + 1];
+        DC_STEP(a & 0xFFFF, y0);
+        DC_STEP(a >> 16, y1);
+        DC_STEP(b & 0xFFFF, y2);
+        DC_STEP(b >> 16, y3);
+        out32[2 * i] = (uint16_t)y0 | ((uint32_t)(uint16_t)y1 << 16);
+        out32[2 * i + 1] = (uint16_t)y2 | ((uint32_t)(uint16_t)y3 << 16);
+    }
+    filter->dc = dc;
+}
+
+// Soma dos quadrados de um bloco (n <= DSP_MAX_SUM_SAMPLES para amostras de 12 bits)
+uint32_t dsp_sum_squares(const int16_t *x, int n) {
+    const uint32_t *x32 = (const uint32_t *)x;
+    uint32_t sum = 0;
+
+    for (int i = 0; i < n / 4; i++) {
+        uint32_t a = x32[2 * i];
+        uint32_t b = x32[2 * i + 1];
+        int32_t s0 = (int16_t)a, s1 = (int32_t)a >> 16;
+        int32_t s2 = (int16_t)b, s3 = (int32_t)b >> 16;
+        sum += s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+    }
+    return sum;
+}
+
+// Raiz quadrada inteira (método dígito a dígito, sem divisão)
+uint32_t dsp_isqrt(uint32_t x) {
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > x)
+        bit >>= 2;
+
+    while (bit) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+// Valor RMS a partir da soma dos quadrados (uma divisão por bloco)
+uint16_t dsp_rms(uint32_t sum_squares, int n) {
+    return (uint16_t)dsp_isqrt(sum_squares / (uint32_t)n);
+}
+
+// Pico absoluto de um bloco
+uint16_t dsp_peak(const int16_t *x, int n) {
+    const uint32_t *x32 = (const uint32_t *)x;
+    int32_t peak = 0;
+
+    for (int i = 0; i < n / 4; i++) {
+        uint32_t a = x32[2 * i];
+        uint32_t b = x32[2 * i + 1];
+        int32_t m0 = dsp_abs((int16_t)a) | dsp_abs((int32_t)a >> 16);
+        int32_t m1 = dsp_abs((int16_t)b) | dsp_abs((int32_t)b >> 16);
+
+        // O OR dá um limite superior barato; só compara os pares candidatos
+        if ((m0 | m1) > peak) {
+            int32_t v;
+            if ((v = dsp_abs((int16_t)a)) > peak) peak = v;
+            if ((v = dsp_abs((int32_t)a >> 16)) > peak) peak = v;
+            if ((v = dsp_abs((int16_t)b)) > peak) peak = v;
+            if ((v = dsp_abs((int32_t)b >> 16)) > peak) peak = v;
+        }
+    }
+    return (uint16_t)peak;
+}
+
+void dsp_envelope_init(Envelope *env, uint8_t attack_shift, uint8_t release_shift) {
+    env->level = 0;
+    env->attack_shift = attack_shift;
+    env->release_shift = release_shift;
+}
+
+// Passo da envoltória: sobe com a constante de ataque, desce com a de liberação
+#define ENV_STEP(s) do {                                        \
+        int32_t _d = (dsp_abs(s) << 8) - level;                 \
+        level += _d >> (_d > 0 ? attack : release);             \
+    } while (0)
+
+// Segue a envoltória de amplitude do bloco; retorna o nível final
+uint16_t dsp_envelope(Envelope *env, const int16_t *x, int n) {
+    const uint32_t *x32 = (const uint32_t *)x;
+    int32_t level = env->level;
+    const int attack = env->attack_shift;
+    const int release = env->release_shift;
+
+    for (int i = 0; i < n / 4; i++) {
+        uint32_t a = x32[2 * i];
+        uint32_t b = x32[2 * i + 1];
+        ENV_STEP((int16_t)a);
+        ENV_STEP((int32_t)a >> 16);
+        ENV_STEP((int16_t)b);
+        ENV_STEP((int32_t)b >> 16);
+    }
+    env->level = level;
+    return (uint16_t)(level >> 8);
+}
+
+void dsp_floor_init(NoiseFloor *nf) {
+    nf->pos = 0;
+    nf->count = 0;
+    nf->sum = 0;
+    nf->sum_squares = 0;
+}
+
+// Acrescenta uma medida, descartando a mais antiga quando a janela está cheia
+void dsp_floor_push(NoiseFloor *nf, uint16_t value) {
+    if (nf->count == DSP_FLOOR_WINDOW) {
+        uint16_t old = nf->values[nf->pos];
+        nf->sum -= old;
+        nf->sum_squares -= (uint32_t)old * old;
+    } else {
+        nf->count++;
+    }
+    nf->values[nf->pos] = value;
+    nf->pos = (nf->pos + 1) & (DSP_FLOOR_WINDOW - 1);
+    nf->sum += value;
+    nf->sum_squares += (uint32_t)value * value;
+}
+
+uint16_t dsp_floor_mean(const NoiseFloor *nf) {
+    if (nf->count == DSP_FLOOR_WINDOW)
+        return (uint16_t)(nf->sum >> DSP_FLOOR_WINDOW_LOG2);
+    return nf->count ? (uint16_t)(nf->sum / nf->count) : 0;
+}
+
+// Desvio padrão: n²·var = n·Σx² - (Σx)², sem perder a parte fracionária da média
+uint16_t dsp_floor_deviation(const NoiseFloor *nf) {
+    uint64_t n = nf->count;
+    if (n < 2)
+        return 0;
+
+    uint64_t scaled = n * nf->sum_squares - (uint64_t)nf->sum * nf->sum;
+    uint64_t variance = n == DSP_FLOOR_WINDOW ? scaled >> (2 * DSP_FLOOR_WINDOW_LOG2) : scaled / (n * n);
+    return (uint16_t)dsp_isqrt(variance > UINT32_MAX ? UINT32_MAX : (uint32_t)variance);
+}
@@ -0,0 +1,51 @@
+#include <stdint.h>
+
+#ifndef audio_dsp_inc_h
+#define audio_dsp_inc_h
+
+// Kernels de áudio em ponto fixo para o Cortex-M0+ (sem FPU).
+// Blocos devem ter tamanho múltiplo de 4 e estar alinhados a 4 bytes:
+// as amostras de 16 bits são lidas e escritas em pares, 32 bits por vez.
+
+#define DSP_DC_SHIFT 7        // Polo do passa-altas: 1 - 2^-7 (~20 Hz a 16 kHz)
+#define DSP_MAX_SUM_SAMPLES 256 // Limite de amostras para a soma de quadrados em 32 bits
+#define DSP_FLOOR_WINDOW_LOG2 8 // Janela do nível de fundo: 256 medidas
+#define DSP_FLOOR_WINDOW (1 << DSP_FLOOR_WINDOW_LOG2)
+
+// Estado do removedor de nível DC (média em Q15 das amostras do ADC)
+typedef struct {
+    int32_t dc;
+} DcFilter;
+
+// Seguidor de envoltória com ataque e liberação exponenciais (estado em Q8)
+typedef struct {
+    int32_t level;
+    uint8_t attack_shift;
+    uint8_t release_shift;
+} Envelope;
+
+// Média e desvio do nível de fundo numa janela deslizante de medidas.
+// Soma e soma dos quadrados são atualizadas a cada medida, então a janela
+// cheia sai por deslocamento; só o preenchimento inicial usa divisão.
+typedef struct {
+    uint16_t values[DSP_FLOOR_WINDOW];
+    uint16_t pos;
+    uint16_t count;
+    uint32_t sum;
+    uint64_t sum_squares;
+} NoiseFloor;
+
+extern void dsp_dc_init(DcFilter *filter, uint16_t bias);
+extern void dsp_dc_remove(DcFilter *filter, const uint16_t *in, int16_t *out, int n);
+extern uint32_t dsp_sum_squares(const int16_t *x, int n);
+extern uint16_t dsp_rms(uint32_t sum_squares, int n);
+extern uint16_t dsp_peak(const int16_t *x, int n);
+extern void dsp_envelope_init(Envelope *env, uint8_t attack_shift, uint8_t release_shift);
+extern uint16_t dsp_envelope(Envelope *env, const int16_t *x, int n);
+extern uint32_t dsp_isqrt(uint32_t x);
+extern void dsp_floor_init(NoiseFloor *nf);
+extern void dsp_floor_push(NoiseFloor *nf, uint16_t value);
+extern uint16_t dsp_floor_mean(const NoiseFloor *nf);
+extern uint16_t dsp_floor_deviation(const NoiseFloor *nf);
+
+#endif
@@ -0,0 +1,174 @@
+#include <string.h>
+#include "beat_tracker.h"
+#include "cycle_counter.h"
+
+// Bordas das colunas em bins (62,5 Hz a 16 kHz): <250 Hz, 500 Hz, 1 kHz, 2 kHz, 8 kHz
+static const uint8_t band_edges[BEAT_BANDS + 1] = {1, 4, 8, 16, 32, SPECTRUM_BINS};
+
+// Peso de cada coluna no fluxo: graves (bumbo, baixo) marcam a batida
+static const uint8_t flux_weight[BEAT_BANDS] = {2, 2, 1, 1, 1};
+
+void beat_tracker_init(BeatTracker *t, uint32_t sample_rate) {
+    memset(t, 0, sizeof(*t));
+    t->frame_rate_x60 = 60 * sample_rate / BEAT_HOP;
+    t->lag_min = t->frame_rate_x60 / BEAT_MAX_BPM;
+    t->lag_max = t->frame_rate_x60 / BEAT_MIN_BPM;
+    if (t->lag_max > BEAT_HISTORY - 2)
+        t->lag_max = BEAT_HISTORY - 2;
+    spectrum_init();
+}
+
+// Níveis das colunas com ganho automático: cada banda se mede contra o próprio
+// pico recente, que decai ~1 oitava por segundo
+static void update_levels(BeatTracker *t, BeatFrame *frame) {
+    for (int b = 0; b < BEAT_BANDS; b++) {
+        uint16_t level = t->band_log[b];
+        uint16_t decay = t->peak[b] > 2 ? 2 : t->peak[b];
+
+        t->peak[b] = level > t->peak[b] - decay ? level : t->peak[b] - decay;
+
+        int32_t above = (int32_t)level - (t->peak[b] - BEAT_RANGE_LOG2);
+        uint8_t lit = 0;
+        if (level >= BEAT_GATE_LOG2 && above > 0) {
+            lit = (above * BEAT_LEVELS + BEAT_RANGE_LOG2 - 1) / BEAT_RANGE_LOG2;
+            if (lit > BEAT_LEVELS)
+                lit = BEAT_LEVELS;
+        }
+
+        // Sobe na hora e desce um LED a cada 4 quadros, para a coluna não piscar
+        if (lit >= t->shown[b])
+            t->shown[b] = lit;
+        else if ((t->frames & 3) == 0)
+            t->shown[b]--;
+        frame->levels[b] = t->shown[b];
+    }
+}
+
+// Autocorrelação no atraso lag suavizada com os vizinhos: o período quase
+// nunca é um número inteiro de quadros
+static int32_t acf_at(const BeatTracker *t, int lag) {
+    return t->acf[lag - 1] + 2 * t->acf[lag] + t->acf[lag + 1];
+}
+
+// Atualiza a autocorrelação do fluxo (sem a média) e escolhe o período
+static void update_tempo(BeatTracker *t) {
+    int32_t now = (int32_t)t->flux[t->flux_pos] - t->flux_mean;
+    int32_t best = 0;
+    uint8_t best_lag = 0;
+
+    t->acf[0] += (now * now - t->acf[0]) >> BEAT_ACF_SHIFT;
+    for (int lag = t->lag_min - 1; lag <= t->lag_max + 1; lag++) {
+        int32_t past = (int32_t)t->flux[(t->flux_pos - lag) & (BEAT_HISTORY - 1)] - t->flux_mean;
+        t->acf[lag] += (now * past - t->acf[lag]) >> BEAT_ACF_SHIFT;
+    }
+    for (int lag = t->lag_min; lag <= t->lag_max; lag++) {
+        int32_t v = acf_at(t, lag);
+        if (v > best) {
+            best = v;
+            best_lag = lag;
+        }
+    }
+
+    // Metade do período quase tão forte quanto ele: fica com o andamento mais rápido
+    uint8_t half = best_lag / 2;
+    if (half >= t->lag_min && 4 * acf_at(t, half) > 3 * best)
+        best_lag = half;
+
+    // Andamento firme só com periodicidade clara diante da variância (atraso 0)
+    t->period = best > t->acf[0] ? best_lag : 0;
+}
+
+// Decide a batida do quadro: pico de fluxo fora do período refratário ou,
+// com o andamento firme, a batida prevista. Um pico logo depois de uma batida
+// prevista só corrige a fase, sem piscar de novo; um pico bem mais forte que
+// o da última batida no meio do período (bumbo contra chimbal no contratempo)
+// muda a fase para ele. Picos com menos da metade da força da última batida
+// não marcam batida.
+static bool detect_beat(BeatTracker *t, uint16_t flux) {
+    uint32_t threshold = t->flux_mean + t->flux_mean / 2 + BEAT_MIN_FLUX;
+    bool onset = flux > threshold && !t->above;
+    uint16_t period = t->period;
+
+    t->above = flux > threshold;
+    if (t->since_beat < UINT16_MAX)
+        t->since_beat++;
+
+    if (onset) {
+        // Com o andamento firme, um pico fraco perto da batida é ruído
+        bool refractory = t->since_beat < (period ? period * 3 / 4 : t->lag_min)
+                          || (period && 2 * flux < t->beat_flux);
+        bool late = t->predicted && t->since_beat < period / 4;
+        bool stronger = period && 2 * flux > 3 * t->beat_flux;
+
+        if (!refractory || late || stronger) {
+            t->since_beat = 0;
+            t->beat_flux = flux;
+            t->misses = 0;
+            t->predicted = false;
+            return !refractory;
+        }
+    }
+    if (period && t->since_beat >= period && t->misses < BEAT_MAX_MISSES) {
+        t->since_beat = 0;
+        t->predicted = true;
+        t->misses++;
+        t->beat_flux /= 2;  // Sem picos reais a exigência de força cai
+        return true;
+    }
+    return false;
+}
+
+static void analyze(BeatTracker *t, BeatFrame *frame) {
+    static Complex16 bins[SPECTRUM_FFT_SIZE];
+    static uint32_t power[SPECTRUM_BINS];
+    uint32_t flux = 0;
+    uint32_t start = cycle_counter_now();
+
+    spectrum_window(t->window, bins);
+    spectrum_fft(bins);
+    spectrum_power(bins, power);
+
+    // Fluxo espectral: soma ponderada dos aumentos de energia (em log) de cada
+    // banda. Abaixo de BEAT_GATE_LOG2 o log só mede ruído e não conta.
+    for (int b = 0; b < BEAT_BANDS; b++) {
+        uint64_t energy = 0;
+        for (int k = band_edges[b]; k < band_edges[b + 1]; k++)
+            energy += power[k];
+        uint16_t level = log2_q8(energy + 1);
+        uint16_t gated = level > BEAT_GATE_LOG2 ? level : BEAT_GATE_LOG2;
+        uint16_t previous = t->band_log[b] > BEAT_GATE_LOG2 ? t->band_log[b] : BEAT_GATE_LOG2;
+        if (gated > previous && t->frames)
+            flux += (gated - previous) * flux_weight[b];
+        t->band_log[b] = level;
+    }
+    if (flux > 4095)
+        flux = 4095;
+
+    t->flux_pos = (t->flux_pos + 1) & (BEAT_HISTORY - 1);
+    t->flux[t->flux_pos] = flux;
+    t->flux_mean += ((int32_t)flux - t->flux_mean) >> 4;
+
+    update_tempo(t);
+    update_levels(t, frame);
+    frame->beat = detect_beat(t, flux);
+    frame->bpm = t->period ? (t->frame_rate_x60 + t->period / 2) / t->period : 0;
+    frame->strength = flux;
+    t->frames++;
+    t->cost = cycle_counter_elapsed(start);
+}
+
+// Acrescenta n amostras sem DC (n divide BEAT_HOP); retorna true e preenche
+// frame quando uma nova análise termina
+bool beat_tracker_process(BeatTracker *t, const int16_t *x, int n, BeatFrame *frame) {
+    memcpy(t->window + BEAT_HOP + t->fill, x, n * sizeof(int16_t));
+    t->fill += n;
+    if (t->fill < BEAT_HOP)
+        return false;
+
+    analyze(t, frame);
+
+    // A segunda metade da janela vira a primeira da próxima análise
+    memcpy(t->window, t->window + BEAT_HOP, BEAT_HOP * sizeof(int16_t));
+    t->fill = 0;
+    return true;
+}
@@ -0,0 +1,58 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "spectrum.h"
+
+#ifndef beat_tracker_inc_h
+#define beat_tracker_inc_h
+
+// Análise de música para as luzes: a cada BEAT_HOP amostras uma FFT de
+// SPECTRUM_FFT_SIZE dá o nível de cinco bandas (as colunas da matriz) e o
+// fluxo espectral, que serve de força de início. A autocorrelação do fluxo,
+// atualizada quadro a quadro, estima o andamento; as batidas saem dos picos
+// de fluxo e, com o andamento firme, também da previsão quando um pico falta.
+
+#define BEAT_HOP (SPECTRUM_FFT_SIZE / 2)  // Uma análise a cada 8 ms a 16 kHz
+#define BEAT_BANDS 5                      // Colunas da matriz (graves à esquerda)
+#define BEAT_LEVELS 5                     // LEDs por coluna
+#define BEAT_HISTORY 128                  // Quadros de fluxo guardados (~1 s)
+#define BEAT_MIN_BPM 60
+#define BEAT_MAX_BPM 180
+#define BEAT_RANGE_LOG2 (4 * 256)         // Faixa de uma coluna: 2^4 em energia (12 dB)
+#define BEAT_GATE_LOG2 (12 * 256)         // Energia mínima de banda para acender
+#define BEAT_ACF_SHIFT 7                  // Memória da autocorrelação (~1 s)
+#define BEAT_MIN_FLUX 64                  // Fluxo mínimo acima da média para uma batida
+#define BEAT_MAX_MISSES 4                 // Batidas previstas seguidas sem pico real
+
+typedef struct {
+    uint8_t levels[BEAT_BANDS];  // LEDs acesos em cada coluna (0 a BEAT_LEVELS)
+    bool beat;                   // Batida neste quadro
+    uint16_t bpm;                // Andamento estimado (0: ainda incerto)
+    uint16_t strength;           // Força de início (fluxo, log2 Q8)
+} BeatFrame;
+
+typedef struct {
+    int16_t window[SPECTRUM_FFT_SIZE] __attribute__((aligned(4)));
+    uint16_t fill;
+    uint16_t band_log[BEAT_BANDS];   // Última energia de cada banda (log2 Q8)
+    uint16_t peak[BEAT_BANDS];       // Pico com decaimento lento, para o ganho automático
+    uint8_t shown[BEAT_BANDS];       // Nível exibido (cai um LED por vez)
+    uint16_t flux[BEAT_HISTORY];     // Força de início dos últimos quadros
+    uint8_t flux_pos;
+    uint16_t flux_mean;              // Média móvel do fluxo
+    int32_t acf[BEAT_HISTORY];       // Autocorrelação do fluxo por atraso (quadros)
+    uint8_t lag_min, lag_max;        // Atrasos de BEAT_MAX_BPM e BEAT_MIN_BPM
+    uint8_t period;                  // Período da batida em quadros (0: incerto)
+    uint16_t since_beat;             // Quadros desde a última batida
+    bool predicted;                  // A última batida veio da previsão
+    uint8_t misses;                  // Previsões seguidas sem pico real
+    bool above;                      // Fluxo acima do limiar no quadro anterior
+    uint16_t beat_flux;              // Fluxo do pico que marcou a última batida
+    uint32_t frame_rate_x60;         // Quadros por minuto
+    uint32_t frames;
+    uint32_t cost;                   // Custo da última análise (ciclos/ns)
+} BeatTracker;
+
+extern void beat_tracker_init(BeatTracker *t, uint32_t sample_rate);
+extern bool beat_tracker_process(BeatTracker *t, const int16_t *x, int n, BeatFrame *frame);
+
+#endif
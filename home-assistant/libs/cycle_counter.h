@@ -0,0 +1,48 @@
+#include <stdint.h>
+
+#ifndef cycle_counter_inc_h
+#define cycle_counter_inc_h
+
+// Contador de custo para medir kernels de áudio. No RP2040 usa o SysTick
+// (24 bits, clock do processador); no host usa o relógio monotônico em ns.
+// Cada núcleo tem o seu SysTick: cycle_counter_init deve rodar no núcleo
+// que executa os kernels medidos (no core1, na sua função de entrada).
+#if PICO_ON_DEVICE
+#include "hardware/structs/systick.h"
+
+#define CYCLE_COUNTER_UNIT "ciclos"
+
+static inline void cycle_counter_init() {
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // Habilita, fonte = clock do processador
+}
+
+static inline uint32_t cycle_counter_now() {
+    return systick_hw->cvr;
+}
+
+// O SysTick é decrescente e dá a volta em 2^24
+static inline uint32_t cycle_counter_elapsed(uint32_t start) {
+    return (start - systick_hw->cvr) & 0x00FFFFFF;
+}
+#else
+#include <time.h>
+
+#define CYCLE_COUNTER_UNIT "ns"
+
+static inline void cycle_counter_init() {
+}
+
+static inline uint32_t cycle_counter_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+static inline uint32_t cycle_counter_elapsed(uint32_t start) {
+    return cycle_counter_now() - start;
+}
+#endif
+
+#endif
@@ -0,0 +1,272 @@
+#include <string.h>
+#include "kws.h"
+#include "cycle_counter.h"
+
+#define C KWS_CHANNELS
+#define MAP (KWS_OUT_T * KWS_OUT_F)
+
+// Enchimento da convolução inicial para saída "same" com passo 2
+#define PAD_T ((((KWS_OUT_T - 1) * 2 + KWS_CONV_T - KWS_FRAMES)) / 2)
+#define PAD_F ((((KWS_OUT_F - 1) * 2 + KWS_CONV_F - MFCC_COEFFS)) / 2)
+
+#if KWS_CHANNELS % 4
+#error "Os kernels processam os canais de 4 em 4"
+#endif
+
+static const char *label_names[KWS_LABELS] = {"silencio", "desconhecido", "luz", "para", "musica", "jogo"};
+
+// Mapas de ativação (tempo x frequência x canal) alternados entre as camadas
+static int8_t act_a[MAP * C] __attribute__((aligned(4)));
+static int8_t act_b[MAP * C] __attribute__((aligned(4)));
+static KwsStats stats;
+
+// Arredonda, desloca e satura com ReLU (ativações internas só positivas)
+static inline int8_t requant_relu(int32_t acc, int shift) {
+    acc = (acc + (1 << (shift - 1))) >> shift;
+    return acc < 0 ? 0 : acc > 127 ? 127 : acc;
+}
+
+static inline int8_t requant(int32_t acc, int shift) {
+    acc = (acc + (1 << (shift - 1))) >> shift;
+    return acc < -128 ? -128 : acc > 127 ? 127 : acc;
+}
+
+static inline int layer_shift(int in_exp, const KwsQuant *q) {
+    return in_exp + q->w_exp - q->out_exp;
+}
+
+// acc[c] += x * w[c] para todos os canais (o M0+ não tem MAC SIMD; o
+// desenrolamento por 4 mantém os acumuladores em registradores)
+static inline void mac_channels(int32_t *acc, int32_t x, const int8_t *w) {
+    for (int c = 0; c < C; c += 4) {
+        acc[c] += x * w[c];
+        acc[c + 1] += x * w[c + 1];
+        acc[c + 2] += x * w[c + 2];
+        acc[c + 3] += x * w[c + 3];
+    }
+}
+
+// Produto escalar de dois vetores int8 de C elementos
+static inline int32_t dot_channels(const int8_t *a, const int8_t *b) {
+    int32_t acc = 0;
+    for (int c = 0; c < C; c += 4)
+        acc += a[c] * b[c] + a[c + 1] * b[c + 1] + a[c + 2] * b[c + 2] + a[c + 3] * b[c + 3];
+    return acc;
+}
+
+// Convolução inicial 10x4, passo 2, de 1 canal para C canais
+static void conv_first(const KwsModel *m, const int8_t (*in)[MFCC_COEFFS], int8_t *out) {
+    const int shift = layer_shift(m->input_exp, &m->conv_q);
+    int32_t acc[C];
+
+    for (int ot = 0; ot < KWS_OUT_T; ot++) {
+        for (int of = 0; of < KWS_OUT_F; of++) {
+            memcpy(acc, m->conv_b, sizeof(acc));
+
+            for (int kt = 0; kt < KWS_CONV_T; kt++) {
+                int t = ot * 2 + kt - PAD_T;
+                if (t < 0 || t >= KWS_FRAMES)
+                    continue;
+                for (int kf = 0; kf < KWS_CONV_F; kf++) {
+                    int f = of * 2 + kf - PAD_F;
+                    if (f < 0 || f >= MFCC_COEFFS || in[t][f] == 0)
+                        continue;
+                    mac_channels(acc, in[t][f], m->conv_w[kt][kf]);
+                }
+            }
+
+            int8_t *o = out + (ot * KWS_OUT_F + of) * C;
+            for (int c = 0; c < C; c++)
+                o[c] = requant_relu(acc[c], shift);
+        }
+    }
+}
+
+// Depthwise 3x3, passo 1, enchimento 1
+static void depthwise(const KwsBlock *b, int in_exp, const int8_t *in, int8_t *out) {
+    const int shift = layer_shift(in_exp, &b->dw_q);
+    int32_t acc[C];
+
+    for (int t = 0; t < KWS_OUT_T; t++) {
+        for (int f = 0; f < KWS_OUT_F; f++) {
+            memcpy(acc, b->dw_b, sizeof(acc));
+
+            for (int kt = 0; kt < 3; kt++) {
+                int it = t + kt - 1;
+                if (it < 0 || it >= KWS_OUT_T)
+                    continue;
+                for (int kf = 0; kf < 3; kf++) {
+                    int jf = f + kf - 1;
+                    if (jf < 0 || jf >= KWS_OUT_F)
+                        continue;
+                    const int8_t *x = in + (it * KWS_OUT_F + jf) * C;
+                    const int8_t *w = b->dw_w[kt][kf];
+                    for (int c = 0; c < C; c += 4) {
+                        acc[c] += x[c] * w[c];
+                        acc[c + 1] += x[c + 1] * w[c + 1];
+                        acc[c + 2] += x[c + 2] * w[c + 2];
+                        acc[c + 3] += x[c + 3] * w[c + 3];
+                    }
+                }
+            }
+
+            int8_t *o = out + (t * KWS_OUT_F + f) * C;
+            for (int c = 0; c < C; c++)
+                o[c] = requant_relu(acc[c], shift);
+        }
+    }
+}
+
+// Pointwise 1x1: mistura os canais de cada posição
+static void pointwise(const KwsBlock *b, int in_exp, const int8_t *in, int8_t *out) {
+    const int shift = layer_shift(in_exp, &b->pw_q);
+
+    for (int p = 0; p < MAP; p++, in += C, out += C)
+        for (int o = 0; o < C; o++)
+            out[o] = requant_relu(b->pw_b[o] + dot_channels(in, b->pw_w[o]), shift);
+}
+
+// Média global (mesma escala da entrada) seguida da camada densa
+static void classify(const KwsModel *m, int in_exp, const int8_t *in, int8_t *logits) {
+    int32_t sum[C] = {0};
+    int8_t pooled[C];
+
+    for (int p = 0; p < MAP; p++, in += C)
+        for (int c = 0; c < C; c++)
+            sum[c] += in[c];
+    for (int c = 0; c < C; c++)
+        pooled[c] = (int8_t)((sum[c] + MAP / 2) / MAP);
+
+    const int shift = layer_shift(in_exp, &m->fc_q);
+    for (int l = 0; l < KWS_LABELS; l++)
+        logits[l] = requant(m->fc_b[l] + dot_channels(pooled, m->fc_w[l]), shift);
+}
+
+// Uma inferência sobre KWS_FRAMES vetores MFCC (do mais antigo ao mais recente)
+void kws_infer(const KwsModel *model, const int8_t (*input)[MFCC_COEFFS], int8_t *logits) {
+    uint32_t total = cycle_counter_now();
+    uint32_t start = total;
+
+    conv_first(model, input, act_a);
+    stats.conv = cycle_counter_elapsed(start);
+
+    start = cycle_counter_now();
+    int exp = model->conv_q.out_exp;
+    for (int i = 0; i < KWS_BLOCKS; i++) {
+        const KwsBlock *b = &model->blocks[i];
+        depthwise(b, exp, act_a, act_b);
+        pointwise(b, b->dw_q.out_exp, act_b, act_a);
+        exp = b->pw_q.out_exp;
+    }
+    stats.blocks = cycle_counter_elapsed(start);
+
+    start = cycle_counter_now();
+    classify(model, exp, act_a, logits);
+    stats.classifier = cycle_counter_elapsed(start);
+    stats.total = cycle_counter_elapsed(total);
+}
+
+void kws_init(KwsSpotter *spotter, const KwsModel *model) {
+    mfcc_init(&spotter->mfcc);
+    spotter->model = model;
+    memset(spotter->features, 0, sizeof(spotter->features));
+    spotter->next = 0;
+    spotter->frames = 0;
+    spotter->since_inference = 0;
+    spotter->last_label = KWS_SILENCE;
+    spotter->streak = 0;
+}
+
+// Consome um bloco de 16 kHz sem DC; retorna true quando uma inferência
+// rodou, com o resultado (e result->detected se a palavra foi aceita)
+bool kws_process(KwsSpotter *s, const int16_t *x, int n, KwsResult *result) {
+    int8_t frames[4][MFCC_COEFFS];
+    int count = mfcc_process(&s->mfcc, x, n, frames, 4);
+
+    for (int i = 0; i < count; i++) {
+        memcpy(s->features[s->next], frames[i], MFCC_COEFFS);
+        s->next = (s->next + 1) % KWS_FRAMES;
+        if (s->frames < KWS_FRAMES)
+            s->frames++;
+        s->since_inference++;
+    }
+    if (s->frames < KWS_FRAMES || s->since_inference < KWS_STRIDE_FRAMES)
+        return false;
+    s->since_inference = 0;
+
+    // Janela linear, do quadro mais antigo ao mais recente
+    static int8_t window[KWS_FRAMES][MFCC_COEFFS];
+    int tail = KWS_FRAMES - s->next;
+    memcpy(window, s->features[s->next], tail * MFCC_COEFFS);
+    memcpy(window[tail], s->features[0], s->next * MFCC_COEFFS);
+    kws_infer(s->model, window, result->logits);
+
+    uint8_t best = 0;
+    for (int l = 1; l < KWS_LABELS; l++)
+        if (result->logits[l] > result->logits[best])
+            best = l;
+    result->label = best;
+    result->score = result->logits[best];
+
+    bool keyword = best >= KWS_LIGHTS && result->score >= KWS_THRESHOLD;
+    s->streak = keyword && best == s->last_label ? s->streak + 1 : keyword;
+    s->last_label = best;
+    result->detected = s->streak >= KWS_CONFIRMATIONS;
+
+    // Depois de aceitar, espera uma janela nova inteira para não repetir a palavra
+    if (result->detected) {
+        s->frames = 0;
+        s->streak = 0;
+    }
+    return true;
+}
+
+// Preenche n pesos com valores pseudoaleatórios em [-64, 63]
+static void fill_random(int8_t *w, size_t n, uint32_t *seed) {
+    for (size_t i = 0; i < n; i++) {
+        *seed = *seed * 1664525 + 1013904223;
+        w[i] = (int8_t)((int)(*seed >> 25) - 64);
+    }
+}
+
+// Pesos de teste: pseudoaleatórios e NÃO treinados. Servem para medir custo
+// e validar os kernels contra a referência do host; as saídas não têm sentido
+// até que um modelo treinado seja exportado no formato KwsModel.
+void kws_placeholder_model(KwsModel *model) {
+    uint32_t seed = 0x2545F491;
+
+    memset(model, 0, sizeof(*model));
+    fill_random(&model->conv_w[0][0][0], sizeof(model->conv_w), &seed);
+    for (int b = 0; b < KWS_BLOCKS; b++) {
+        fill_random(&model->blocks[b].dw_w[0][0][0], sizeof(model->blocks[b].dw_w), &seed);
+        fill_random(&model->blocks[b].pw_w[0][0], sizeof(model->blocks[b].pw_w), &seed);
+    }
+    fill_random(&model->fc_w[0][0], sizeof(model->fc_w), &seed);
+
+    // Deslocamentos medidos com a referência do host para manter as ativações
+    // dentro de int8 (saída = entrada + w_exp - deslocamento)
+    const int shift_conv = 8, shift_dw = 7, shift_pw = 7, shift_fc = 6;
+    int exp = MFCC_OUTPUT_SHIFT;
+    model->input_exp = exp;
+    model->conv_q = (KwsQuant){7, exp = exp + 7 - shift_conv};
+    for (int b = 0; b < KWS_BLOCKS; b++) {
+        model->blocks[b].dw_q = (KwsQuant){7, exp = exp + 7 - shift_dw};
+        model->blocks[b].pw_q = (KwsQuant){7, exp = exp + 7 - shift_pw};
+    }
+    model->fc_q = (KwsQuant){7, exp + 7 - shift_fc};
+}
+
+// Multiplicações-acumulações por inferência (sem contar a média)
+uint32_t kws_macs() {
+    return MAP * C * KWS_CONV_T * KWS_CONV_F
+         + KWS_BLOCKS * MAP * C * (9 + C)
+         + KWS_LABELS * C;
+}
+
+const char *kws_label_name(uint8_t label) {
+    return label < KWS_LABELS ? label_names[label] : "?";
+}
+
+const KwsStats *kws_stats() {
+    return &stats;
+}
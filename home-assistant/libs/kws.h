@@ -0,0 +1,93 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "mfcc.h"
+
+#ifndef kws_inc_h
+#define kws_inc_h
+
+// Detecção de palavras-chave: MFCC de ~1 s de fala numa DS-CNN int8
+// (convolução inicial + blocos separáveis em profundidade + média + densa).
+// Quantização em potências de 2: tensor = int8 * 2^-exp, então cada camada
+// só precisa de um deslocamento no acumulador de 32 bits.
+
+#define KWS_FRAMES 49              // 49 quadros de 20 ms (~1 s)
+#define KWS_CHANNELS 24            // Canais das camadas internas (múltiplo de 4)
+#define KWS_CONV_T 10              // Núcleo da convolução inicial (tempo x frequência)
+#define KWS_CONV_F 4
+#define KWS_OUT_T 25               // Mapa após a convolução inicial (passo 2)
+#define KWS_OUT_F 5
+#define KWS_BLOCKS 2               // Blocos depthwise 3x3 + pointwise 1x1
+#define KWS_STRIDE_FRAMES 12       // Uma inferência a cada 240 ms
+#define KWS_THRESHOLD 48           // Logit mínimo (na escala da saída) para aceitar
+#define KWS_CONFIRMATIONS 2        // Inferências seguidas com a mesma palavra
+
+typedef enum {
+    KWS_SILENCE,
+    KWS_UNKNOWN,
+    KWS_LIGHTS,                    // "luz"
+    KWS_STOP,                      // "para"
+    KWS_MUSIC,                     // "música"
+    KWS_GAME,                      // "jogo"
+    KWS_LABELS
+} KwsLabel;
+
+typedef struct {
+    int8_t w_exp;                  // Pesos = int8 * 2^-w_exp
+    int8_t out_exp;                // Saída = int8 * 2^-out_exp
+} KwsQuant;
+
+typedef struct {
+    int8_t dw_w[3][3][KWS_CHANNELS];
+    int32_t dw_b[KWS_CHANNELS];    // Bias na escala do acumulador
+    KwsQuant dw_q;
+    int8_t pw_w[KWS_CHANNELS][KWS_CHANNELS]; // [saída][entrada]
+    int32_t pw_b[KWS_CHANNELS];
+    KwsQuant pw_q;
+} KwsBlock;
+
+typedef struct {
+    int8_t input_exp;              // Escala dos coeficientes MFCC
+    int8_t conv_w[KWS_CONV_T][KWS_CONV_F][KWS_CHANNELS];
+    int32_t conv_b[KWS_CHANNELS];
+    KwsQuant conv_q;
+    KwsBlock blocks[KWS_BLOCKS];
+    int8_t fc_w[KWS_LABELS][KWS_CHANNELS];
+    int32_t fc_b[KWS_LABELS];
+    KwsQuant fc_q;
+} KwsModel;
+
+typedef struct {
+    uint8_t label;                 // KwsLabel de maior logit
+    int8_t score;                  // Logit da palavra escolhida
+    bool detected;                 // Palavra aceita (limiar + confirmações)
+    int8_t logits[KWS_LABELS];
+} KwsResult;
+
+typedef struct {
+    MfccFrontEnd mfcc;
+    const KwsModel *model;
+    int8_t features[KWS_FRAMES][MFCC_COEFFS]; // Circular, do quadro mais antigo em next
+    uint8_t next;
+    uint8_t frames;                // Quadros válidos (até KWS_FRAMES)
+    uint8_t since_inference;
+    uint8_t last_label;
+    uint8_t streak;
+} KwsSpotter;
+
+// Custo da última inferência por etapa (ciclos no RP2040, ns no host)
+typedef struct {
+    uint32_t conv;
+    uint32_t blocks;
+    uint32_t classifier;
+    uint32_t total;
+} KwsStats;
+
+extern void kws_init(KwsSpotter *spotter, const KwsModel *model);
+extern bool kws_process(KwsSpotter *spotter, const int16_t *x, int n, KwsResult *result);
+extern void kws_infer(const KwsModel *model, const int8_t (*input)[MFCC_COEFFS], int8_t *logits);
+extern void kws_placeholder_model(KwsModel *model);
+extern uint32_t kws_macs();
+extern const char *kws_label_name(uint8_t label);
+extern const KwsStats *kws_stats();
+
+#endif
@@ -0,0 +1,129 @@
+#include <string.h>
+#include "mfcc.h"
+#include "cycle_counter.h"
+
+// Bordas dos filtros mel em bins de 31,25 Hz: o filtro b sobe de edges[b]
+// até edges[b + 1] e desce até edges[b + 2] (mel uniforme de 125 a 3800 Hz)
+static const uint8_t mel_edges[MFCC_MEL_BANDS + 2] = {
+    4, 6, 9, 11, 14, 17, 20, 24, 28, 32, 37, 42, 47, 53, 59, 66, 74, 82, 91, 100, 110, 122,
+};
+
+// DCT-II ortonormal em Q14: sqrt(2/M) cos(pi k (2m + 1) / 2M), k = 1..10
+static const int16_t dct_table[MFCC_COEFFS][MFCC_MEL_BANDS] = {
+    {5165, 5038, 4787, 4418, 3940, 3365, 2707, 1983, 1209, 407, -407, -1209, -1983, -2707, -3365, -3940, -4418, -4787, -5038, -5165},
+    {5117, 4616, 3664, 2352, 810, -810, -2352, -3664, -4616, -5117, -5117, -4616, -3664, -2352, -810, 810, 2352, 3664, 4616, 5117},
+    {5038, 3940, 1983, -407, -2707, -4418, -5165, -4787, -3365, -1209, 1209, 3365, 4787, 5165, 4418, 2707, 407, -1983, -3940, -5038},
+    {4927, 3045, 0, -3045, -4927, -4927, -3045, 0, 3045, 4927, 4927, 3045, 0, -3045, -4927, -4927, -3045, 0, 3045, 4927},
+    {4787, 1983, -1983, -4787, -4787, -1983, 1983, 4787, 4787, 1983, -1983, -4787, -4787, -1983, 1983, 4787, 4787, 1983, -1983, -4787},
+    {4616, 810, -3664, -5117, -2352, 2352, 5117, 3664, -810, -4616, -4616, -810, 3664, 5117, 2352, -2352, -5117, -3664, 810, 4616},
+    {4418, -407, -4787, -3940, 1209, 5038, 3365, -1983, -5165, -2707, 2707, 5165, 1983, -3365, -5038, -1209, 3940, 4787, 407, -4418},
+    {4192, -1601, -5181, -1601, 4192, 4192, -1601, -5181, -1601, 4192, 4192, -1601, -5181, -1601, 4192, 4192, -1601, -5181, -1601, 4192},
+    {3940, -2707, -4787, 1209, 5165, 407, -5038, -1983, 4418, 3365, -3365, -4418, 1983, 5038, -407, -5165, -1209, 4787, 2707, -3940},
+    {3664, -3664, -3664, 3664, 3664, -3664, -3664, 3664, 3664, -3664, -3664, 3664, 3664, -3664, -3664, 3664, 3664, -3664, -3664, 3664},
+};
+
+// Peso (Q8) da rampa de subida de cada bin e o filtro ao qual ela pertence;
+// a rampa de descida do filtro anterior tem peso 256 - w no mesmo bin
+static uint8_t rise_weight[SPECTRUM_BINS];
+static int8_t rise_band[SPECTRUM_BINS];
+static MfccStats stats;
+
+void mfcc_init(MfccFrontEnd *m) {
+    memset(m, 0, sizeof(*m));
+    m->fill = MFCC_FRAME - MFCC_HOP;
+
+    for (int k = 0; k < SPECTRUM_BINS; k++) {
+        rise_band[k] = -1;
+        rise_weight[k] = 0;
+    }
+    for (int b = 0; b <= MFCC_MEL_BANDS; b++) {
+        int lo = mel_edges[b], hi = mel_edges[b + 1];
+        for (int k = lo; k < hi; k++) {
+            rise_band[k] = b;  // b == MFCC_MEL_BANDS: só a descida do último filtro
+            rise_weight[k] = (uint8_t)((k - lo) * 256 / (hi - lo));
+        }
+    }
+    spectrum_init();
+}
+
+// Log2 (Q8) da energia de cada filtro mel para um quadro de 8 kHz sem DC
+void mfcc_log_mel(const int16_t *frame, uint16_t *log_mel) {
+    static Complex16 bins[SPECTRUM_FFT_SIZE];
+    static uint32_t power[SPECTRUM_BINS];
+    uint64_t energy[MFCC_MEL_BANDS + 1] = {0};
+    uint32_t start = cycle_counter_now();
+
+    spectrum_window(frame, bins);
+    spectrum_fft(bins);
+    spectrum_power(bins, power);
+    stats.spectrum = cycle_counter_elapsed(start);
+
+    start = cycle_counter_now();
+    for (int k = mel_edges[0]; k < mel_edges[MFCC_MEL_BANDS + 1]; k++) {
+        int b = rise_band[k];
+        uint32_t w = rise_weight[k];
+        energy[b] += (uint64_t)power[k] * w;
+        if (b > 0)
+            energy[b - 1] += (uint64_t)power[k] * (256 - w);
+    }
+    for (int b = 0; b < MFCC_MEL_BANDS; b++)
+        log_mel[b] = log2_q8(energy[b] + MFCC_ENERGY_FLOOR);
+    stats.mel = cycle_counter_elapsed(start);
+}
+
+// Coeficientes 1..MFCC_COEFFS das energias mel, quantizados em int8
+void mfcc_dct(const uint16_t *log_mel, int8_t *coeffs) {
+    uint32_t start = cycle_counter_now();
+
+    for (int k = 0; k < MFCC_COEFFS; k++) {
+        const int16_t *row = dct_table[k];
+        int32_t acc = 0;
+        for (int b = 0; b < MFCC_MEL_BANDS; b += 4)
+            acc += log_mel[b] * row[b] + log_mel[b + 1] * row[b + 1]
+                 + log_mel[b + 2] * row[b + 2] + log_mel[b + 3] * row[b + 3];
+
+        // Q14 * Q8 -> unidades de 2^-MFCC_OUTPUT_SHIFT log2, com arredondamento
+        const int shift = 14 + 8 - MFCC_OUTPUT_SHIFT;
+        int32_t c = (acc + (1 << (shift - 1))) >> shift;
+        coeffs[k] = c > 127 ? 127 : c < -128 ? -128 : c;
+    }
+    stats.dct = cycle_counter_elapsed(start);
+}
+
+// Consome n amostras de 16 kHz sem DC (n par) e escreve um vetor de
+// coeficientes a cada MFCC_HOP amostras decimadas; retorna quantos
+int mfcc_process(MfccFrontEnd *m, const int16_t *x, int n,
+                 int8_t (*out)[MFCC_COEFFS], int max_frames) {
+    int16_t *d = m->delay;
+    int frames = 0;
+
+    for (int i = 0; i < n; i++) {
+        // Meia-banda [-1 0 9 16 9 0 -1] / 32: corta acima de 4 kHz antes de decimar
+        d[0] = d[1]; d[1] = d[2]; d[2] = d[3]; d[3] = d[4]; d[4] = d[5]; d[5] = d[6];
+        d[6] = x[i];
+        if (m->phase ^= 1)
+            continue;
+
+        int32_t y = 16 * d[3] + 9 * (d[2] + d[4]) - (d[0] + d[6]);
+        m->frame[m->fill++] = (int16_t)(y >> 5);
+        if (m->fill < MFCC_FRAME)
+            continue;
+
+        if (frames < max_frames) {
+            uint16_t log_mel[MFCC_MEL_BANDS];
+            mfcc_log_mel(m->frame, log_mel);
+            mfcc_dct(log_mel, out[frames++]);
+        }
+        memmove(m->frame, m->frame + MFCC_HOP, (MFCC_FRAME - MFCC_HOP) * sizeof(int16_t));
+        m->fill = MFCC_FRAME - MFCC_HOP;
+    }
+    return frames;
+}
+
+const uint8_t *mfcc_mel_edges() {
+    return mel_edges;
+}
+
+const MfccStats *mfcc_stats() {
+    return &stats;
+}
@@ -0,0 +1,42 @@
+#include <stdint.h>
+#include "spectrum.h"
+
+#ifndef mfcc_inc_h
+#define mfcc_inc_h
+
+// Coeficientes mel-cepstrais em ponto fixo para a detecção de palavras.
+// O fluxo de 16 kHz é decimado para 8 kHz (fala até 4 kHz), e cada quadro
+// de SPECTRUM_FFT_SIZE amostras (32 ms) passa pela FFT do módulo spectrum.
+
+#define MFCC_DECIMATION 2                   // 16 kHz -> 8 kHz
+#define MFCC_RATE 8000
+#define MFCC_FRAME SPECTRUM_FFT_SIZE        // 256 amostras (32 ms)
+#define MFCC_HOP 160                        // Avanço entre quadros (20 ms)
+#define MFCC_MEL_BANDS 20                   // Filtros triangulares de 125 Hz a 3,8 kHz
+#define MFCC_COEFFS 10                      // Coeficientes 1..10 (c0, a energia, fica de fora)
+#define MFCC_ENERGY_FLOOR (1 << 15)         // Piso do banco mel, acima do ruído de arredondamento da FFT
+#define MFCC_OUTPUT_SHIFT 2                 // Saída int8 em 1/4 de log2 (~1,5 dB)
+
+typedef struct {
+    int16_t delay[7];                       // Linha de atraso do decimador
+    uint8_t phase;                          // Amostra par/ímpar da entrada
+    int16_t frame[MFCC_FRAME];              // Últimas amostras a 8 kHz
+    uint16_t fill;                          // Amostras válidas em frame
+} MfccFrontEnd;
+
+// Custo do último quadro por etapa (ciclos no RP2040, ns no host)
+typedef struct {
+    uint32_t spectrum;                      // Janela + FFT + potência
+    uint32_t mel;                           // Banco mel + log
+    uint32_t dct;
+} MfccStats;
+
+extern void mfcc_init(MfccFrontEnd *m);
+extern int mfcc_process(MfccFrontEnd *m, const int16_t *x, int n,
+                        int8_t (*out)[MFCC_COEFFS], int max_frames);
+extern void mfcc_log_mel(const int16_t *frame, uint16_t *log_mel);
+extern void mfcc_dct(const uint16_t *log_mel, int8_t *coeffs);
+extern const uint8_t *mfcc_mel_edges();
+extern const MfccStats *mfcc_stats();
+
+#endif
@@ -0,0 +1,160 @@
+#include "hardware/sync.h"
+#include "midi_stream.h"
+
+#define CLOCK_MAX_GAP_US 100000    // Intervalo maior que isso: o relógio parou
+
+typedef struct {
+    MidiMessage message;
+    uint64_t due_us;               // Chegada + latência
+} MidiEvent;
+
+static MidiEvent events[MIDI_QUEUE_SIZE];
+static SpscQueue queue;            // Laço principal -> interrupção do alarme
+static MidiOutput output;
+static alarm_id_t alarm = 0;
+static uint64_t alarm_deadline;    // Prazo para o qual o alarme está agendado
+static MidiStats stats;
+static uint64_t last_clock_us;
+static uint32_t clock_min_us, clock_max_us;
+
+void midi_parser_init(MidiParser *p) {
+    p->running = 0;
+    p->count = 0;
+    p->needed = 0;
+    p->sysex = false;
+}
+
+// Consome um byte; true quando message recebe uma mensagem completa. Nota
+// ligada com velocidade 0 sai como nota desligada.
+bool midi_parse(MidiParser *p, uint8_t byte, MidiMessage *message) {
+    if (byte >= 0xF8) {
+        // Tempo real: pode vir no meio de outra mensagem e não a interrompe
+        message->status = byte;
+        message->data1 = message->data2 = 0;
+        return true;
+    }
+    if (byte >= 0xF0) {
+        // SysEx e mensagens comuns de sistema: ignoradas, e cancelam o running status
+        p->sysex = byte == 0xF0;
+        p->running = 0;
+        return false;
+    }
+    if (byte & 0x80) {
+        p->running = byte;
+        p->count = 0;
+        p->needed = (byte & 0xE0) == 0xC0 ? 1 : 2;   // Programa e pressão de canal: 1 byte
+        p->sysex = false;
+        return false;
+    }
+    if (p->sysex || p->running == 0)
+        return false;
+
+    p->data[p->count++] = byte;
+    if (p->count < p->needed)
+        return false;
+    p->count = 0;   // Running status: os próximos dados reusam o status
+
+    message->status = p->running;
+    message->data1 = p->data[0];
+    message->data2 = p->needed > 1 ? p->data[1] : 0;
+    if ((message->status & 0xF0) == 0x90 && message->data2 == 0)
+        message->status = 0x80 | (message->status & 0x0F);
+    return true;
+}
+
+// Entrega tudo o que venceu e reagenda para o próximo prazo, contando a
+// partir do prazo anterior do alarme, como no sequenciador
+static int64_t midi_callback(alarm_id_t id, void *user_data) {
+    uint64_t now = time_us_64();
+    const MidiEvent *event;
+
+    while ((event = spsc_peek(&queue)) && event->due_us <= now) {
+        MidiEvent e;
+        spsc_pop(&queue, &e);
+
+        uint32_t late = now - e.due_us;
+        if (late > stats.max_late_us)
+            stats.max_late_us = late;
+        if (late > MIDI_LATE_US)
+            stats.late++;
+        // Um início de nota com mais atraso que a latência inteira não é mais
+        // ao vivo; finais de nota sempre passam, para nenhuma ficar presa
+        if (late > MIDI_LATENCY_US && (e.message.status & 0xF0) == 0x90) {
+            stats.dropped++;
+            continue;
+        }
+        output(&e.message);
+        stats.played++;
+    }
+
+    if (!event) {
+        alarm = 0;
+        return 0;
+    }
+    int64_t delay = event->due_us > alarm_deadline ? (int64_t)(event->due_us - alarm_deadline) : 1;
+    alarm_deadline += delay;
+    return -delay;
+}
+
+void midi_player_start(MidiOutput out) {
+    midi_player_stop();
+    output = out;
+    spsc_init(&queue, events, sizeof(MidiEvent), MIDI_QUEUE_SIZE);
+
+    MidiStats empty = {0};
+    stats = empty;
+    last_clock_us = 0;
+    clock_min_us = UINT32_MAX;
+    clock_max_us = 0;
+}
+
+// Chamado pelo laço principal com o instante em que os bytes chegaram
+void midi_player_push(const MidiMessage *message, uint64_t arrival_us) {
+    if (message->status == MIDI_CLOCK) {
+        // O relógio só mede o jitter da entrada: o intervalo nominal é fixo
+        uint64_t interval = arrival_us - last_clock_us;
+        if (last_clock_us && interval < CLOCK_MAX_GAP_US) {
+            if (interval < clock_min_us)
+                clock_min_us = interval;
+            if (interval > clock_max_us)
+                clock_max_us = interval;
+        }
+        last_clock_us = arrival_us;
+        return;
+    }
+
+    MidiEvent e = {*message, arrival_us + MIDI_LATENCY_US};
+    uint32_t irq = save_and_disable_interrupts();
+    if (spsc_push(&queue, &e)) {
+        stats.received++;
+        if (alarm == 0) {
+            // Buffer estava vazio: este evento é o próximo prazo
+            alarm_deadline = e.due_us;
+            alarm = add_alarm_at(from_us_since_boot(e.due_us), midi_callback, NULL, true);
+        }
+    } else
+        stats.dropped++;
+    restore_interrupts(irq);
+}
+
+// Para o alarme e descarta o que está no buffer
+void midi_player_stop() {
+    uint32_t irq = save_and_disable_interrupts();
+    if (alarm > 0)
+        cancel_alarm(alarm);
+    alarm = 0;
+    if (queue.items)
+        queue.tail = queue.head;
+    restore_interrupts(irq);
+}
+
+// Copia os contadores; o pior atraso e o jitter do relógio recomeçam a cada chamada
+void midi_player_stats(MidiStats *out) {
+    uint32_t irq = save_and_disable_interrupts();
+    *out = stats;
+    out->clock_jitter_us = clock_max_us >= clock_min_us ? clock_max_us - clock_min_us : 0;
+    stats.max_late_us = 0;
+    clock_min_us = UINT32_MAX;
+    clock_max_us = 0;
+    restore_interrupts(irq);
+}
@@ -0,0 +1,52 @@
+#include "pico/stdlib.h"
+#include "spsc_queue.h"
+
+#ifndef midi_stream_inc_h
+#define midi_stream_inc_h
+
+// MIDI ao vivo pela USB: o parser consome o fluxo de bytes um a um (com
+// running status, mensagens de tempo real no meio de outras e SysEx
+// ignorado) e cada mensagem entra num buffer de jitter com o instante em que
+// chegou. Um alarme de hardware a entrega em chegada + latência fixa, então
+// a demora variável do laço principal não chega ao som; o que passar do
+// prazo é contado como atrasado (ou descartado, se for um início de nota
+// velho demais).
+
+#define MIDI_LATENCY_US 20000      // Latência fixa da chegada ao som
+#define MIDI_LATE_US 1000          // Entregue depois do prazo mais que isso: atrasada
+#define MIDI_QUEUE_SIZE 64         // Mensagens no buffer de jitter (potência de 2)
+#define MIDI_CLOCK 0xF8            // Relógio de tempo real (24 por semínima)
+
+typedef struct {
+    uint8_t status;                // Com o canal nos 4 bits baixos
+    uint8_t data1, data2;
+} MidiMessage;
+
+typedef struct {
+    uint8_t running;               // Status em vigor (0: nenhum)
+    uint8_t data[2];
+    uint8_t count, needed;
+    bool sysex;
+} MidiParser;
+
+typedef struct {
+    uint32_t received;             // Mensagens que entraram no buffer
+    uint32_t played;
+    uint32_t late;                 // Tocadas mais de MIDI_LATE_US depois do prazo
+    uint32_t dropped;              // Buffer cheio ou início de nota velho demais
+    uint32_t max_late_us;          // Pior atraso no período
+    uint32_t clock_jitter_us;      // Variação do intervalo entre relógios (0xF8) no período
+} MidiStats;
+
+// Entrega de uma mensagem no prazo. Roda na interrupção do alarme.
+typedef void (*MidiOutput)(const MidiMessage *message);
+
+extern void midi_parser_init(MidiParser *p);
+extern bool midi_parse(MidiParser *p, uint8_t byte, MidiMessage *message);
+
+extern void midi_player_start(MidiOutput output);
+extern void midi_player_push(const MidiMessage *message, uint64_t arrival_us);
+extern void midi_player_stop();
+extern void midi_player_stats(MidiStats *stats);
+
+#endif
@@ -0,0 +1,52 @@
+#include <stdint.h>
+
+#ifndef note_pitch_inc_h
+#define note_pitch_inc_h
+
+// Afinação das notas no PWM, calculada pelo compilador. As frequências são
+// as do temperamento igual (A4 = 440 Hz) em mHz; para cada uma, o divisor
+// de clock (8.4 bits, em 1/16) é o menor que deixa o período caber em 16
+// bits, o que dá o maior topo e a menor quantização da frequência (abaixo de
+// 0,05 cent em todas as notas a 125 MHz). Tocar uma nota vira uma consulta
+// à tabela, sem divisão em ponto flutuante no RP2040.
+
+#ifndef SYS_CLK_KHZ
+#define SYS_CLK_KHZ 125000
+#endif
+
+#define NOTE_COUNT 96      // C0 a B7
+#define NOTE_REST NOTE_COUNT
+
+typedef struct {
+    uint16_t div16;        // Divisor do clock em 1/16 (parte inteira << 4 | fração)
+    uint16_t wrap;         // Topo do contador: período = div16 / 16 * (wrap + 1)
+} NotePwm;
+
+// clk_sys * 16 * 1000: dividido por uma frequência em mHz dá o período em 1/16 de ciclo
+#define NOTE_CLK16_MHZ ((uint64_t)SYS_CLK_KHZ * 16000000u)
+#define NOTE_DIV16_MIN(mhz) ((NOTE_CLK16_MHZ + (uint64_t)(mhz) * 65536 - 1) / ((uint64_t)(mhz) * 65536))
+#define NOTE_PWM_DIV16(mhz) (NOTE_DIV16_MIN(mhz) < 16 ? 16 : NOTE_DIV16_MIN(mhz))
+#define NOTE_PWM_WRAP(mhz) \
+    ((NOTE_CLK16_MHZ + (uint64_t)(mhz) * NOTE_PWM_DIV16(mhz) / 2) / ((uint64_t)(mhz) * NOTE_PWM_DIV16(mhz)) - 1)
+#define NOTE_PWM(mhz) {(uint16_t)NOTE_PWM_DIV16(mhz), (uint16_t)NOTE_PWM_WRAP(mhz)}
+
+// X(nome, mHz) para cada nota, de C0 a B7
+#define NOTE_LIST(X) \
+    X("C0", 16352) X("C#0", 17324) X("D0", 18354) X("D#0", 19445) X("E0", 20602) X("F0", 21827) \
+    X("F#0", 23125) X("G0", 24500) X("G#0", 25957) X("A0", 27500) X("A#0", 29135) X("B0", 30868) \
+    X("C1", 32703) X("C#1", 34648) X("D1", 36708) X("D#1", 38891) X("E1", 41203) X("F1", 43654) \
+    X("F#1", 46249) X("G1", 48999) X("G#1", 51913) X("A1", 55000) X("A#1", 58270) X("B1", 61735) \
+    X("C2", 65406) X("C#2", 69296) X("D2", 73416) X("D#2", 77782) X("E2", 82407) X("F2", 87307) \
+    X("F#2", 92499) X("G2", 97999) X("G#2", 103826) X("A2", 110000) X("A#2", 116541) X("B2", 123471) \
+    X("C3", 130813) X("C#3", 138591) X("D3", 146832) X("D#3", 155563) X("E3", 164814) X("F3", 174614) \
+    X("F#3", 184997) X("G3", 195998) X("G#3", 207652) X("A3", 220000) X("A#3", 233082) X("B3", 246942) \
+    X("C4", 261626) X("C#4", 277183) X("D4", 293665) X("D#4", 311127) X("E4", 329628) X("F4", 349228) \
+    X("F#4", 369994) X("G4", 391995) X("G#4", 415305) X("A4", 440000) X("A#4", 466164) X("B4", 493883) \
+    X("C5", 523251) X("C#5", 554365) X("D5", 587330) X("D#5", 622254) X("E5", 659255) X("F5", 698456) \
+    X("F#5", 739989) X("G5", 783991) X("G#5", 830609) X("A5", 880000) X("A#5", 932328) X("B5", 987767) \
+    X("C6", 1046502) X("C#6", 1108731) X("D6", 1174659) X("D#6", 1244508) X("E6", 1318510) X("F6", 1396913) \
+    X("F#6", 1479978) X("G6", 1567982) X("G#6", 1661219) X("A6", 1760000) X("A#6", 1864655) X("B6", 1975533) \
+    X("C7", 2093005) X("C#7", 2217461) X("D7", 2349318) X("D#7", 2489016) X("E7", 2637020) X("F7", 2793826) \
+    X("F#7", 2959955) X("G7", 3135963) X("G#7", 3322438) X("A7", 3520000) X("A#7", 3729310) X("B7", 3951066)
+
+#endif
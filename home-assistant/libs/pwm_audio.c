@@ -0,0 +1,142 @@
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "pwm_audio.h"
+
+// Palavras do registrador CC do PWM (canal A nos 16 bits baixos, B nos altos)
+static uint32_t buffers[2][PWM_AUDIO_BLOCK] __attribute__((aligned(4)));
+static int16_t pcm[PWM_AUDIO_BLOCK];
+
+static int dma_chan[2] = {-1, -1};
+static int dma_timer = -1;
+static uint audio_gpio;
+static uint level_shift;              // 0: canal A, 16: canal B
+static PwmAudioFill fill_block;
+static volatile bool active = false;
+static volatile int8_t last_buffer;   // Buffer com o fim do áudio (-1: ainda não)
+static bool handler_added = false;
+
+// Pede o próximo bloco e converte para níveis do PWM em torno do meio da
+// escala. O outro canal do mesmo slice recebe nível 0.
+static void refill(int i) {
+    int n = last_buffer < 0 ? fill_block(pcm, PWM_AUDIO_BLOCK) : 0;
+
+    if (n < PWM_AUDIO_BLOCK && last_buffer < 0)
+        last_buffer = i;
+    for (int s = 0; s < PWM_AUDIO_BLOCK; s++) {
+        int32_t level = s < n ? (pcm[s] >> 8) + 128 : 128;
+        buffers[i][s] = (uint32_t)level << level_shift;
+    }
+}
+
+static void release() {
+    if (dma_chan[0] >= 0 && dma_chan[1] >= 0) {
+        dma_channel_set_irq1_enabled(dma_chan[0], false);
+        dma_channel_set_irq1_enabled(dma_chan[1], false);
+
+        // Desfaz o encadeamento (cada canal aponta para si mesmo) antes do
+        // abort; sem isso, o canal abortado primeiro pode ser religado pelo outro
+        for (int i = 0; i < 2; i++) {
+            dma_channel_config c = dma_get_channel_config(dma_chan[i]);
+            channel_config_set_chain_to(&c, dma_chan[i]);
+            dma_channel_set_config(dma_chan[i], &c, false);
+        }
+        while (dma_channel_is_busy(dma_chan[0]) || dma_channel_is_busy(dma_chan[1])) {
+            dma_channel_abort(dma_chan[0]);
+            dma_channel_abort(dma_chan[1]);
+        }
+    }
+    // Só com os dois canais parados eles e o timer voltam ao pool
+    for (int i = 0; i < 2; i++) {
+        if (dma_chan[i] < 0)
+            continue;
+        dma_channel_acknowledge_irq1(dma_chan[i]);
+        dma_channel_unclaim(dma_chan[i]);
+        dma_chan[i] = -1;
+    }
+    if (dma_timer >= 0) {
+        dma_timer_unclaim(dma_timer);
+        dma_timer = -1;
+    }
+    pwm_set_gpio_level(audio_gpio, 0);
+    active = false;
+}
+
+// Fim de um buffer: o canal encadeado já está tocando o outro; este é
+// preenchido de novo e rearmado no início do mesmo buffer
+static void pwm_audio_dma_handler() {
+    for (int i = 0; i < 2; i++) {
+        if (dma_chan[i] < 0 || !dma_channel_get_irq1_status(dma_chan[i]))
+            continue;
+
+        dma_channel_acknowledge_irq1(dma_chan[i]);
+        if (last_buffer == i) {
+            release();  // O último bloco acabou de tocar
+            return;
+        }
+        refill(i);
+        dma_channel_set_read_addr(dma_chan[i], buffers[i], false);
+    }
+}
+
+void pwm_audio_start(uint gpio, uint32_t sample_rate, PwmAudioFill fill) {
+    if (active)
+        pwm_audio_stop();
+
+    audio_gpio = gpio;
+    level_shift = pwm_gpio_to_channel(gpio) ? 16 : 0;
+    fill_block = fill;
+    last_buffer = -1;
+
+    uint slice = pwm_gpio_to_slice_num(gpio);
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_clkdiv(&config, 1.0f);
+    pwm_config_set_wrap(&config, PWM_AUDIO_WRAP);
+    pwm_init(slice, &config, true);
+    gpio_set_function(gpio, GPIO_FUNC_PWM);
+
+    // Timer de DMA: clk_sys * 1 / den (125 MHz / 15625 = 8 kHz exatos)
+    dma_timer = dma_claim_unused_timer(true);
+    dma_timer_set_fraction(dma_timer, 1, clock_get_hz(clk_sys) / sample_rate);
+
+    refill(0);
+    refill(1);
+    dma_chan[0] = dma_claim_unused_channel(true);
+    dma_chan[1] = dma_claim_unused_channel(true);
+    for (int i = 0; i < 2; i++) {
+        dma_channel_config c = dma_channel_get_default_config(dma_chan[i]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_dreq(&c, dma_get_timer_dreq(dma_timer));
+        channel_config_set_chain_to(&c, dma_chan[!i]);
+        dma_channel_configure(dma_chan[i], &c, &pwm_hw->slice[slice].cc, buffers[i], PWM_AUDIO_BLOCK, false);
+        dma_channel_set_irq1_enabled(dma_chan[i], true);
+    }
+
+    // DMA_IRQ_0 fica com o serviço do ADC
+    if (!handler_added) {
+        irq_add_shared_handler(DMA_IRQ_1, pwm_audio_dma_handler,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        handler_added = true;
+    }
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    active = true;
+    dma_channel_start(dma_chan[0]);
+}
+
+bool pwm_audio_active() {
+    return active;
+}
+
+// Interrompe a reprodução e deixa o pino em nível 0
+void pwm_audio_stop() {
+    uint32_t irq = save_and_disable_interrupts();
+    if (active)
+        release();
+    restore_interrupts(irq);
+}
@@ -0,0 +1,24 @@
+#include "pico/stdlib.h"
+
+#ifndef pwm_audio_inc_h
+#define pwm_audio_inc_h
+
+// Saída de áudio por PWM: o nível de comparação do canal vira um DAC de
+// 8 bits (portadora de clk_sys / 256, ~488 kHz, filtrada pelo próprio
+// buzzer). Dois canais de DMA encadeados, cadenciados por um timer de DMA na
+// taxa de amostragem, copiam os níveis para o PWM; a interrupção de fim de
+// buffer pede o bloco seguinte à função de preenchimento, então o áudio sai
+// em fluxo sem que o programa precise parar.
+
+#define PWM_AUDIO_BLOCK 256   // Amostras por buffer (32 ms a 8 kHz)
+#define PWM_AUDIO_WRAP 255    // Resolução do DAC: 8 bits
+
+// Preenche até n amostras de 16 bits com sinal e retorna quantas escreveu;
+// menos que n encerra a reprodução. Roda na interrupção do DMA.
+typedef int (*PwmAudioFill)(int16_t *samples, int n);
+
+extern void pwm_audio_start(uint gpio, uint32_t sample_rate, PwmAudioFill fill);
+extern bool pwm_audio_active();
+extern void pwm_audio_stop();
+
+#endif
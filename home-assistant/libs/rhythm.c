@@ -0,0 +1,187 @@
+#include <string.h>
+#include "rhythm.h"
+
+// Começa uma sequência nova com todos os padrões gravados na disputa
+static void reset_sequence(RhythmMatcher *m) {
+    m->count = 0;
+    m->overflow = false;
+    m->longest = 0;
+    m->alive = 0;
+    for (int p = 0; p < RHYTHM_PATTERNS; p++)
+        if (m->patterns[p].onsets)
+            m->alive |= 1u << p;
+}
+
+void rhythm_init(RhythmMatcher *m, uint32_t sample_rate) {
+    memset(m, 0, sizeof(*m));
+    m->end_min = RHYTHM_END_MIN_MS * sample_rate / 1000;
+    m->end_max = RHYTHM_END_MAX_MS * sample_rate / 1000;
+    m->recording = -1;
+    reset_sequence(m);
+}
+
+// Grava a próxima sequência (de ao menos RHYTHM_MIN_ONSETS batidas) no
+// padrão indicado; -1 cancela a gravação
+void rhythm_record(RhythmMatcher *m, int pattern) {
+    m->recording = pattern < RHYTHM_PATTERNS ? pattern : -1;
+    reset_sequence(m);
+}
+
+void rhythm_forget(RhythmMatcher *m, uint8_t pattern) {
+    if (pattern >= RHYTHM_PATTERNS)
+        return;
+    m->patterns[pattern].onsets = 0;
+    reset_sequence(m);
+}
+
+// Quantos padrões estão gravados
+uint8_t rhythm_stored(const RhythmMatcher *m) {
+    uint8_t stored = 0;
+
+    for (int p = 0; p < RHYTHM_PATTERNS; p++)
+        stored += m->patterns[p].onsets != 0;
+    return stored;
+}
+
+// Intervalos da sequência atual em 1/256 da duração (uma divisão por intervalo)
+static uint32_t normalize(const RhythmMatcher *m, uint8_t *intervals) {
+    uint32_t duration = m->onsets[m->count - 1] - m->onsets[0];
+
+    for (int i = 0; i + 1 < m->count; i++) {
+        uint32_t v = ((m->onsets[i + 1] - m->onsets[i]) * 256 + duration / 2) / duration;
+        intervals[i] = v > 255 ? 255 : v;
+    }
+    return duration;
+}
+
+// Descarta os padrões incompatíveis com a batida recém-chegada: curtos demais,
+// lentos demais ou com o novo intervalo fora de ±50% do esperado em relação ao
+// primeiro. O teste é por produtos cruzados; o ajuste fino fica para o fim.
+static void prune(RhythmMatcher *m) {
+    int i = m->count - 2;
+    uint32_t first = m->onsets[1] - m->onsets[0];
+    uint32_t newest = m->onsets[i + 1] - m->onsets[i];
+    uint32_t elapsed = m->onsets[i + 1] - m->onsets[0];
+
+    for (int p = 0; p < RHYTHM_PATTERNS; p++) {
+        const RhythmPattern *pattern = &m->patterns[p];
+        if (!(m->alive & (1u << p)))
+            continue;
+
+        bool fits = m->count <= pattern->onsets && elapsed <= 2 * pattern->duration;
+        if (fits && i > 0) {
+            int32_t expected = (int32_t)(first * pattern->intervals[i]);
+            int32_t got = (int32_t)(newest * pattern->intervals[0]);
+            int32_t diff = got > expected ? got - expected : expected - got;
+            fits = diff <= expected / 2;
+        }
+        if (!fits)
+            m->alive &= ~(1u << p);
+    }
+}
+
+// Encerra a sequência: grava o padrão em gravação ou escolhe o padrão de
+// mesmo número de batidas, andamento entre 1/2x e 2x e menor desvio
+static RhythmResult finish(RhythmMatcher *m, RhythmMatch *match) {
+    uint8_t intervals[RHYTHM_MAX_ONSETS - 1];
+    RhythmResult result = RHYTHM_UNMATCHED;
+
+    *match = (RhythmMatch){-1, m->count, 255};
+    if (m->recording >= 0) {
+        // Sequência curta demais (ou longa demais) não encerra a gravação
+        if (m->count < RHYTHM_MIN_ONSETS || m->overflow) {
+            reset_sequence(m);
+            return RHYTHM_NONE;
+        }
+        RhythmPattern *pattern = &m->patterns[m->recording];
+        pattern->duration = normalize(m, pattern->intervals);
+        pattern->onsets = m->count;
+        match->pattern = m->recording;
+        match->error = 0;
+        m->recording = -1;
+        reset_sequence(m);
+        return RHYTHM_RECORDED;
+    }
+
+    if (!m->overflow && m->count >= 2) {
+        uint32_t duration = normalize(m, intervals);
+        for (int p = 0; p < RHYTHM_PATTERNS; p++) {
+            const RhythmPattern *pattern = &m->patterns[p];
+            if (!(m->alive & (1u << p)) || pattern->onsets != m->count)
+                continue;
+            if (2 * duration < pattern->duration || duration > 2 * pattern->duration)
+                continue;
+
+            uint8_t error = 0;
+            for (int i = 0; i + 1 < m->count; i++) {
+                int d = intervals[i] - pattern->intervals[i];
+                if (d < 0)
+                    d = -d;
+                if (d > error)
+                    error = d;
+            }
+            if (error <= RHYTHM_TOLERANCE && error < match->error) {
+                match->pattern = p;
+                match->error = error;
+            }
+        }
+        if (match->pattern >= 0)
+            result = RHYTHM_MATCH;
+    }
+    reset_sequence(m);
+    return result;
+}
+
+// Registra uma batida no instante t (em amostras). Retorna RHYTHM_MATCH ou
+// RHYTHM_UNMATCHED quando a sequência já pode ser decidida: algum padrão
+// completo e nenhum mais longo ainda compatível.
+RhythmResult rhythm_onset(RhythmMatcher *m, uint32_t t, RhythmMatch *match) {
+    // Sequência esquecida por falta de rhythm_poll: começa outra
+    if (m->count && t - m->last > m->end_max)
+        reset_sequence(m);
+
+    m->last = t;
+    if (m->count == RHYTHM_MAX_ONSETS) {
+        m->overflow = true;
+        m->alive = 0;
+        return RHYTHM_NONE;
+    }
+
+    m->onsets[m->count++] = t;
+    if (m->count < 2)
+        return RHYTHM_NONE;
+
+    uint32_t interval = t - m->onsets[m->count - 2];
+    if (interval > m->longest)
+        m->longest = interval;
+    if (m->recording >= 0)
+        return RHYTHM_NONE;  // Na gravação só o silêncio encerra a sequência
+
+    prune(m);
+    bool complete = false, longer = false;
+    for (int p = 0; p < RHYTHM_PATTERNS; p++) {
+        if (!(m->alive & (1u << p)))
+            continue;
+        complete |= m->patterns[p].onsets == m->count;
+        longer |= m->patterns[p].onsets > m->count;
+    }
+    if (complete && !longer)
+        return finish(m, match);
+    return RHYTHM_NONE;
+}
+
+// Encerra a sequência depois de um silêncio de 2x o maior intervalo (entre
+// RHYTHM_END_MIN_MS e RHYTHM_END_MAX_MS); chamar a cada bloco de áudio
+RhythmResult rhythm_poll(RhythmMatcher *m, uint32_t now, RhythmMatch *match) {
+    if (!m->count)
+        return RHYTHM_NONE;
+
+    uint32_t end = 2 * m->longest;
+    if (end < m->end_min)
+        end = m->end_min;
+    if (end > m->end_max)
+        end = m->end_max;
+    if (now - m->last <= end)
+        return RHYTHM_NONE;
+    return finish(m, match);
+}
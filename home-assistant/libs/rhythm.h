@@ -0,0 +1,59 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef rhythm_inc_h
+#define rhythm_inc_h
+
+// Reconhecimento de códigos rítmicos (batidas, palmas) pelos instantes dos
+// inícios. Um padrão guarda os intervalos entre batidas como fração da
+// duração total, então o mesmo código tocado mais rápido ou mais devagar
+// continua reconhecido. A comparação é feita a cada início: os padrões
+// incompatíveis saem logo da disputa e o código é aceito assim que nenhum
+// padrão mais longo continua possível.
+
+#define RHYTHM_PATTERNS 4            // Códigos que podem ser gravados
+#define RHYTHM_MAX_ONSETS 8          // Batidas por código
+#define RHYTHM_MIN_ONSETS 3          // Duas batidas já são o duplo aplauso
+#define RHYTHM_TOLERANCE 32          // Desvio máximo de cada intervalo, em 1/256 da duração
+#define RHYTHM_END_MIN_MS 700        // Silêncio que encerra uma sequência: 2x o maior
+#define RHYTHM_END_MAX_MS 1500       // intervalo, entre estes limites
+
+typedef struct {
+    uint8_t onsets;                              // Batidas (0: vazio)
+    uint8_t intervals[RHYTHM_MAX_ONSETS - 1];    // Intervalos em 1/256 da duração
+    uint32_t duration;                           // Duração gravada em amostras
+} RhythmPattern;
+
+typedef enum {
+    RHYTHM_NONE,
+    RHYTHM_MATCH,          // Sequência reconhecida como um padrão
+    RHYTHM_UNMATCHED,      // Sequência encerrada sem padrão (onsets diz quantas batidas)
+    RHYTHM_RECORDED        // Padrão gravado
+} RhythmResult;
+
+typedef struct {
+    int8_t pattern;        // Padrão reconhecido ou gravado (-1: nenhum)
+    uint8_t onsets;        // Batidas na sequência
+    uint8_t error;         // Maior desvio de intervalo, em 1/256 da duração
+} RhythmMatch;
+
+typedef struct {
+    RhythmPattern patterns[RHYTHM_PATTERNS];
+    uint32_t onsets[RHYTHM_MAX_ONSETS];  // Instantes (em amostras) da sequência atual
+    uint8_t count;
+    uint32_t last;                       // Última batida (também após o excesso)
+    bool overflow;                       // Mais batidas que RHYTHM_MAX_ONSETS
+    uint8_t alive;                       // Padrões ainda compatíveis (bit por padrão)
+    uint32_t longest;                    // Maior intervalo da sequência
+    uint32_t end_min, end_max;           // Silêncio que encerra a sequência, em amostras
+    int8_t recording;                    // Padrão em gravação (-1: nenhum)
+} RhythmMatcher;
+
+extern void rhythm_init(RhythmMatcher *m, uint32_t sample_rate);
+extern void rhythm_record(RhythmMatcher *m, int pattern);
+extern void rhythm_forget(RhythmMatcher *m, uint8_t pattern);
+extern uint8_t rhythm_stored(const RhythmMatcher *m);
+extern RhythmResult rhythm_onset(RhythmMatcher *m, uint32_t t, RhythmMatch *match);
+extern RhythmResult rhythm_poll(RhythmMatcher *m, uint32_t now, RhythmMatch *match);
+
+#endif
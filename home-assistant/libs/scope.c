@@ -0,0 +1,73 @@
+#include <string.h>
+#include "scope.h"
+#include "audio_dsp.h"
+
+void scope_init(Scope *s) {
+    memset(s, 0, sizeof(*s));
+    spectrum_init();
+}
+
+// Coluna de uma amplitude em contagens do ADC na escala log do histórico
+static uint8_t level_column(uint32_t level) {
+    uint32_t x = (uint32_t)log2_q8(level + 1) * (SCOPE_WIDTH - 1) / SCOPE_FULL_LOG2;
+    return x < SCOPE_WIDTH ? x : SCOPE_WIDTH - 1;
+}
+
+// Espectro da janela em tons, com ganho automático pelo maior bin recente
+static void spectrum_row(Scope *s, ScopeRow *row) {
+    static Complex16 bins[SPECTRUM_FFT_SIZE];
+    static uint32_t power[SPECTRUM_BINS];
+    uint16_t top = 0;
+
+    spectrum_window(s->window, bins);
+    spectrum_fft(bins);
+    spectrum_power(bins, power);
+
+    for (int k = 1; k < SPECTRUM_BINS; k++) {
+        uint16_t level = log2_q8(power[k] + 1);
+        if (level > top)
+            top = level;
+    }
+    // O topo sobe na hora e desce ~1 oitava por segundo
+    s->top = top > s->top - 4 ? top : s->top - 4;
+
+    int32_t bottom = (int32_t)s->top - SCOPE_RANGE_LOG2;
+    for (int k = 0; k < SPECTRUM_BINS; k++) {
+        int32_t v = (int32_t)log2_q8(power[k] + 1) - bottom;
+        v = v <= 0 ? 0 : v * SCOPE_SHADES / SCOPE_RANGE_LOG2;
+        row->shade[k] = v > SCOPE_SHADES ? SCOPE_SHADES : v;
+    }
+}
+
+// Barra do pico da linha; as colunas dos limiares aparecem invertidas
+static void level_row(Scope *s, uint16_t clap_level, uint16_t noise_level, ScopeRow *row) {
+    uint8_t bar = level_column(s->peak);
+
+    memset(row->shade, SCOPE_SHADES, bar);
+    memset(row->shade + bar, 0, SCOPE_WIDTH - bar);
+    row->shade[level_column(clap_level)] ^= SCOPE_SHADES;
+    row->shade[level_column(noise_level)] ^= SCOPE_SHADES;
+}
+
+// Acrescenta n amostras sem DC (n divide SCOPE_ROW_SAMPLES); retorna true e
+// preenche row quando uma linha da visualização escolhida fica pronta
+bool scope_process(Scope *s, ScopeView view, const int16_t *x, int n,
+                   uint16_t clap_level, uint16_t noise_level, ScopeRow *row) {
+    uint16_t peak = dsp_peak(x, n);
+
+    if (peak > s->peak)
+        s->peak = peak;
+    if (view == SCOPE_SPECTRUM)
+        memcpy(s->window + s->fill, x, n * sizeof(int16_t));
+    s->fill += n;
+    if (s->fill < SCOPE_ROW_SAMPLES)
+        return false;
+
+    if (view == SCOPE_SPECTRUM)
+        spectrum_row(s, row);
+    else
+        level_row(s, clap_level, noise_level, row);
+    s->fill = 0;
+    s->peak = 0;
+    return view != SCOPE_OFF;
+}
@@ -0,0 +1,40 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "spectrum.h"
+
+#ifndef scope_inc_h
+#define scope_inc_h
+
+// Linhas da visualização do microfone na tela: espectrograma em cascata
+// (0 a 8 kHz da esquerda para a direita) ou histórico de nível com os
+// limiares do detector. Cada linha tem um tom de 0 a SCOPE_SHADES por
+// coluna; a tela rola uma linha por vez.
+
+#define SCOPE_WIDTH 128                      // Colunas (uma por bin da FFT)
+#define SCOPE_SHADES 16                      // Tom máximo de um pixel
+#define SCOPE_ROW_SAMPLES SPECTRUM_FFT_SIZE  // Amostras por linha (16 ms a 16 kHz)
+#define SCOPE_RANGE_LOG2 (10 * 256)          // Faixa do espectrograma: 2^10 em potência (30 dB)
+#define SCOPE_FULL_LOG2 (12 * 256)           // Fundo de escala do nível: 4096 contagens
+
+typedef enum {
+    SCOPE_OFF,
+    SCOPE_SPECTRUM,    // Espectrograma em cascata
+    SCOPE_LEVEL        // Pico de cada linha em escala log, com marcas dos limiares
+} ScopeView;
+
+typedef struct {
+    uint8_t shade[SCOPE_WIDTH];
+} ScopeRow;
+
+typedef struct {
+    int16_t window[SCOPE_ROW_SAMPLES] __attribute__((aligned(4)));
+    uint16_t fill;
+    uint16_t peak;       // Pico das amostras da linha em curso
+    uint16_t top;        // Maior bin recente (log2 Q8), com decaimento, para o ganho
+} Scope;
+
+extern void scope_init(Scope *s);
+extern bool scope_process(Scope *s, ScopeView view, const int16_t *x, int n,
+                          uint16_t clap_level, uint16_t noise_level, ScopeRow *row);
+
+#endif
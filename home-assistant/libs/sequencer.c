@@ -0,0 +1,206 @@
+#include "hardware/sync.h"
+#include "sequencer.h"
+
+typedef enum {
+    SEQ_STOPPED,
+    SEQ_NOTE,              // Nota soando até o prazo
+    SEQ_GAP                // Silêncio no fim da nota até o prazo
+} SeqPhase;
+
+typedef struct {
+    volatile uint8_t phase;            // SeqPhase
+    uint64_t deadline;                 // Prazo absoluto do próximo evento (us)
+    uint64_t remaining;                // Tempo até o prazo no momento da pausa
+    SeqTone current;                   // Nota atual (para retomar da pausa)
+    SeqTone onset;                     // Última nota iniciada, para os LEDs
+    volatile bool onset_dirty;
+} SeqVoice;
+
+static SeqOutput output;
+static SeqNextTone next_tone;
+static uint32_t gap_us;
+static alarm_id_t alarm = 0;
+static uint64_t alarm_deadline;        // Prazo para o qual o alarme está agendado
+static SeqVoice voices[SEQ_VOICES];
+static volatile bool paused = false;
+
+// Inicia a próxima nota da voz; false se a voz acabou. Notas de duração 0
+// começam junto com a seguinte (acorde) e terminam com ela.
+static bool start_tone(uint8_t v) {
+    SeqVoice *voice = &voices[v];
+
+    do {
+        if (!next_tone(v, &voice->current)) {
+            voice->phase = SEQ_STOPPED;
+            output(v, SEQ_SILENCE);
+            return false;
+        }
+        output(v, voice->current.note);
+        voice->onset = voice->current;
+        voice->onset_dirty = true;
+    } while (voice->current.duration_ms == 0);
+    voice->phase = SEQ_NOTE;
+    return true;
+}
+
+// Parte da nota que soa: o silêncio entre notas sai do fim dela (notas
+// mais curtas que o silêncio soam inteiras), então cada nota ocupa
+// exatamente sua duração e vozes com ritmos diferentes não se desalinham
+static uint32_t sound_us(const SeqTone *tone) {
+    uint32_t us = tone->duration_ms * 1000u;
+    return us > gap_us ? us - gap_us : us;
+}
+
+// Trata o prazo vencido da voz: fim da parte que soa (silêncio até o fim da
+// nota) ou início da seguinte
+static void advance(uint8_t v) {
+    SeqVoice *voice = &voices[v];
+    uint32_t rest = voice->current.duration_ms * 1000u - sound_us(&voice->current);
+
+    if (voice->phase == SEQ_NOTE)
+        output(v, SEQ_SILENCE);
+    if (voice->phase == SEQ_NOTE && rest > 0) {
+        voice->phase = SEQ_GAP;
+        voice->deadline += rest;
+    } else if (start_tone(v))
+        voice->deadline += sound_us(&voice->current);
+}
+
+// Prazo mais próximo entre as vozes ativas; false se todas acabaram
+static bool next_deadline(uint64_t *deadline) {
+    bool any = false;
+
+    for (int v = 0; v < SEQ_VOICES; v++) {
+        if (voices[v].phase == SEQ_STOPPED)
+            continue;
+        if (!any || voices[v].deadline < *deadline)
+            *deadline = voices[v].deadline;
+        any = true;
+    }
+    return any;
+}
+
+// Atende todas as vozes com prazo vencido e reagenda para o próximo prazo.
+// O valor negativo conta a partir do prazo anterior do alarme, não do
+// instante atual, então atrasos da interrupção não se acumulam.
+static int64_t sequencer_callback(alarm_id_t id, void *user_data) {
+    uint64_t next;
+
+    for (int v = 0; v < SEQ_VOICES; v++)
+        if (voices[v].phase != SEQ_STOPPED && voices[v].deadline <= alarm_deadline)
+            advance(v);
+
+    if (!next_deadline(&next)) {
+        alarm = 0;
+        return 0;
+    }
+    int64_t delay = next > alarm_deadline ? (int64_t)(next - alarm_deadline) : 1;
+    alarm_deadline += delay;
+    return -delay;
+}
+
+static void schedule() {
+    if (next_deadline(&alarm_deadline))
+        alarm = add_alarm_at(from_us_since_boot(alarm_deadline), sequencer_callback, NULL, true);
+}
+
+void sequencer_init(SeqOutput out, uint16_t gap_ms) {
+    sequencer_stop();
+    output = out;
+    gap_us = gap_ms * 1000u;
+}
+
+// Começa a tocar as vozes de next a partir de agora
+void sequencer_play(SeqNextTone next) {
+    sequencer_stop();
+    next_tone = next;
+
+    uint64_t now = time_us_64();
+    uint32_t irq = save_and_disable_interrupts();
+    for (int v = 0; v < SEQ_VOICES; v++) {
+        voices[v].deadline = now;
+        if (start_tone(v))
+            voices[v].deadline += sound_us(&voices[v].current);
+    }
+    schedule();
+    restore_interrupts(irq);
+}
+
+// Silencia e guarda quanto faltava para o prazo de cada voz
+void sequencer_pause() {
+    uint32_t irq = save_and_disable_interrupts();
+    if (sequencer_active() && !paused) {
+        if (alarm > 0)
+            cancel_alarm(alarm);
+        alarm = 0;
+        uint64_t now = time_us_64();
+        for (int v = 0; v < SEQ_VOICES; v++) {
+            SeqVoice *voice = &voices[v];
+            if (voice->phase == SEQ_STOPPED)
+                continue;
+            voice->remaining = voice->deadline > now ? voice->deadline - now : 0;
+            output(v, SEQ_SILENCE);
+        }
+        paused = true;
+    }
+    restore_interrupts(irq);
+}
+
+// Retoma do ponto da pausa: as notas interrompidas soam pelo tempo que faltava
+void sequencer_resume() {
+    uint32_t irq = save_and_disable_interrupts();
+    if (paused) {
+        paused = false;
+        uint64_t now = time_us_64();
+        for (int v = 0; v < SEQ_VOICES; v++) {
+            SeqVoice *voice = &voices[v];
+            if (voice->phase == SEQ_STOPPED)
+                continue;
+            if (voice->phase == SEQ_NOTE)
+                output(v, voice->current.note);
+            voice->deadline = now + voice->remaining;
+        }
+        schedule();
+    }
+    restore_interrupts(irq);
+}
+
+void sequencer_stop() {
+    uint32_t irq = save_and_disable_interrupts();
+    if (alarm > 0)
+        cancel_alarm(alarm);
+    alarm = 0;
+    paused = false;
+    for (int v = 0; v < SEQ_VOICES; v++) {
+        if (voices[v].phase != SEQ_STOPPED && output)
+            output(v, SEQ_SILENCE);
+        voices[v].phase = SEQ_STOPPED;
+    }
+    restore_interrupts(irq);
+}
+
+// Alguma voz tocando ou pausada no meio da música
+bool sequencer_active() {
+    for (int v = 0; v < SEQ_VOICES; v++)
+        if (voices[v].phase != SEQ_STOPPED)
+            return true;
+    return false;
+}
+
+bool sequencer_paused() {
+    return paused;
+}
+
+// Chamado pelo laço principal: true (com a nota) se uma nota da voz começou
+bool sequencer_poll(uint8_t voice, SeqTone *tone) {
+    SeqVoice *v = &voices[voice];
+
+    if (!v->onset_dirty)
+        return false;
+
+    uint32_t irq = save_and_disable_interrupts();
+    *tone = v->onset;
+    v->onset_dirty = false;
+    restore_interrupts(irq);
+    return true;
+}
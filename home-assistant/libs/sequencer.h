@@ -0,0 +1,38 @@
+#include "pico/stdlib.h"
+
+#ifndef sequencer_inc_h
+#define sequencer_inc_h
+
+// Sequenciador de música por alarme de hardware: cada voz liga e desliga suas
+// notas em prazos absolutos (o próximo prazo soma a duração ao prazo
+// anterior, não ao instante em que a interrupção rodou), então a música não
+// acumula atraso. Um único alarme atende a fila de eventos de todas as vozes:
+// dispara no prazo mais próximo, trata todas as vozes vencidas e se reagenda
+// para o seguinte. O silêncio entre notas (gap_ms) sai do fim de cada nota,
+// então a voz dura exatamente a soma das durações. O som muda na própria
+// interrupção; o início de cada nota é publicado para o laço principal
+// acender os LEDs, como no action_player.
+
+#define SEQ_VOICES 2       // Melodia e baixo
+#define SEQ_SILENCE 0xFF   // Nota passada à saída no silêncio entre notas
+
+typedef struct {
+    uint8_t note;          // Nota para a saída (fora da tabela dela: pausa)
+    uint16_t duration_ms;  // 0: soa junto com a próxima nota da voz (acorde)
+} SeqTone;
+
+// Próxima nota da voz; false encerra a voz. Roda na interrupção do alarme.
+typedef bool (*SeqNextTone)(uint8_t voice, SeqTone *tone);
+// Liga o som da voz na nota (SEQ_SILENCE: silêncio). Roda na interrupção do alarme.
+typedef void (*SeqOutput)(uint8_t voice, uint8_t note);
+
+extern void sequencer_init(SeqOutput output, uint16_t gap_ms);
+extern void sequencer_play(SeqNextTone next);
+extern void sequencer_pause();
+extern void sequencer_resume();
+extern void sequencer_stop();
+extern bool sequencer_active();
+extern bool sequencer_paused();
+extern bool sequencer_poll(uint8_t voice, SeqTone *tone);
+
+#endif
@@ -0,0 +1,97 @@
+#include <stddef.h>
+#include "song_format.h"
+
+#define SONG_DEFAULT_BPM 120
+#define SONG_LOOP_UNSET 0xFFFF
+
+void song_decoder_init(SongDecoder *d, const uint16_t *voice) {
+    d->pos = voice;
+    d->bpm = SONG_DEFAULT_BPM;
+    d->transpose = 0;
+    d->base_ms = 0;
+    d->ticks = 0;
+    d->depth = 0;
+}
+
+// Tempo da música no tique atual, em ms. Contar a partir do início (e não
+// somar a duração arredondada de cada nota) mantém vozes com ritmos
+// diferentes alinhadas: o mesmo tique dá o mesmo instante nas duas.
+// 60000 / (16 * bpm) ms por tique = 3750 / bpm.
+static uint32_t song_time_ms(const SongDecoder *d) {
+    return d->base_ms + d->ticks * 3750u / d->bpm;
+}
+
+static void command(SongDecoder *d, uint8_t op, uint16_t arg) {
+    switch (op) {
+    case SONG_CMD_TEMPO:
+        if (arg == 0)
+            break;
+        d->base_ms = song_time_ms(d);
+        d->ticks = 0;
+        d->bpm = arg;
+        break;
+    case SONG_CMD_TRANSPOSE:
+        d->transpose = (int8_t)arg;
+        break;
+    case SONG_CMD_REPEAT:
+        if (d->depth < SONG_REPEAT_DEPTH) {
+            d->repeats[d->depth].start = d->pos;
+            d->repeats[d->depth].left = SONG_LOOP_UNSET;
+            d->depth++;
+        }
+        break;
+    case SONG_CMD_LOOP:
+        if (d->depth == 0)
+            break;
+        if (d->repeats[d->depth - 1].left == SONG_LOOP_UNSET)
+            d->repeats[d->depth - 1].left = arg > 0 ? arg - 1 : 0;
+        if (d->repeats[d->depth - 1].left > 0) {
+            d->repeats[d->depth - 1].left--;
+            d->pos = d->repeats[d->depth - 1].start;
+        } else
+            d->depth--;
+        break;
+    }
+}
+
+// Próxima nota da voz (índice de NOTE_LIST ou NOTE_REST) e sua duração;
+// false no SONG_END. Só contas inteiras: roda na interrupção do alarme.
+bool song_decoder_next(SongDecoder *d, uint8_t *note, uint16_t *duration_ms) {
+    if (d->pos == NULL)
+        return false;
+
+    for (;;) {
+        uint16_t word = *d->pos;
+
+        if (word & 0x8000) {
+            uint8_t op = word >> 12 & 7;
+            if (op == SONG_CMD_END)
+                return false;
+            d->pos++;
+            command(d, op, word & 0xFFF);
+            continue;
+        }
+        d->pos++;
+
+        int n = word >> 8;
+        if (n != SONG_NOTE_REST) {
+            n += d->transpose;
+            if (n < 0 || n >= NOTE_COUNT)
+                n = NOTE_REST;   // Fora da tabela depois da transposição
+        } else
+            n = NOTE_REST;
+        *note = n;
+
+        uint32_t start = song_time_ms(d);
+        d->ticks += word & 0xFF;
+        uint32_t end = song_time_ms(d);
+        *duration_ms = end - start > 0xFFFF ? 0xFFFF : end - start;
+
+        // A cada bpm tiques passam 3750 ms exatos: mantém os produtos pequenos
+        if (d->ticks >= d->bpm) {
+            d->base_ms += d->ticks / d->bpm * 3750u;
+            d->ticks %= d->bpm;
+        }
+        return true;
+    }
+}
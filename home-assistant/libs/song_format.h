@@ -0,0 +1,99 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "note_pitch.h"
+
+#ifndef song_format_inc_h
+#define song_format_inc_h
+
+// Formato compacto das músicas: cada voz é uma sequência de palavras de 16
+// bits, lida em ordem até SONG_END, sem tamanho guardado (não há limite de
+// notas). Uma palavra com o bit 15 em 0 é uma nota:
+//
+//   0 nnnnnnn dddddddd   nota n (índice de libs/note_pitch.h, SONG_NOTE_REST:
+//                        pausa) por d tiques; d = 0 soa junto com a próxima
+//                        nota (acorde)
+//
+// Com o bit 15 em 1 é um comando de 3 bits com argumento de 12 bits:
+// andamento, transposição e repetição de trechos. O tique é 1/16 de tempo
+// (semifusa), então as durações do RTTTL, inclusive pontuadas, são exatas.
+// As tabelas são geradas pelo host/song_compiler ou escritas com as macros
+// abaixo, e ficam na flash (const).
+
+#define SONG_TICKS_PER_BEAT 16
+#define SONG_NOTE_REST 0x7F
+#define SONG_MAX_TICKS 0xFF
+#define SONG_MAX_BPM 0xFFF
+#define SONG_REPEAT_DEPTH 4        // Repetições aninhadas
+
+#define SONG_CMD_TEMPO 0           // Argumento: tempos por minuto (1 a 4095)
+#define SONG_CMD_TRANSPOSE 1       // Argumento: semitons (int8), vale até o próximo
+#define SONG_CMD_REPEAT 2          // Início de um trecho repetido
+#define SONG_CMD_LOOP 3            // Fim do trecho; argumento: vezes que ele toca no total
+#define SONG_CMD_END 7
+
+#define SONG_CMD(op, arg) ((uint16_t)(0x8000 | (op) << 12 | ((arg) & 0xFFF)))
+#define SONG_NOTE(note, ticks) ((uint16_t)((note) << 8 | (ticks)))
+#define SONG_REST(ticks) SONG_NOTE(SONG_NOTE_REST, ticks)
+#define SONG_TEMPO(bpm) SONG_CMD(SONG_CMD_TEMPO, bpm)
+#define SONG_TRANSPOSE(semitones) SONG_CMD(SONG_CMD_TRANSPOSE, (uint8_t)(int8_t)(semitones))
+#define SONG_REPEAT SONG_CMD(SONG_CMD_REPEAT, 0)
+#define SONG_LOOP(times) SONG_CMD(SONG_CMD_LOOP, times)
+#define SONG_END SONG_CMD(SONG_CMD_END, 0)
+
+typedef struct {
+    const char *title;             // Até SONG_TITLE_CHARS caracteres, sem '\0' se tiver todos
+    uint8_t program;               // Instrumento no número General MIDI (0 a 127)
+    const uint16_t *melody;        // Voz 0
+    const uint16_t *bass;          // Voz 1 (NULL: sem baixo)
+    uint32_t duration_ms;
+} PackedSong;
+
+// Biblioteca de músicas: imagem gravada numa região própria da flash (veja
+// song_library.h), com um cabeçalho, count entradas de índice de tamanho
+// fixo (a música i está num endereço calculado, sem busca) e as vozes. Os
+// deslocamentos contam do início da imagem; tudo em little-endian.
+#define SONG_LIBRARY_MAGIC 0x42494C53   // "SLIB"
+#define SONG_LIBRARY_VERSION 1
+#define SONG_LIBRARY_MAX_BYTES (512 * 1024)
+#define SONG_TITLE_CHARS 16            // Uma linha do display
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;                // Entradas no índice
+    uint32_t bytes;                // Tamanho da imagem
+    uint32_t reserved;
+} SongLibraryHeader;
+
+typedef struct {
+    char title[SONG_TITLE_CHARS];
+    uint32_t melody;               // Deslocamento da voz 0
+    uint32_t bass;                 // Deslocamento da voz 1 (0: sem baixo)
+    uint32_t melody_words;         // Palavras de cada voz, com o SONG_END
+    uint32_t bass_words;
+    uint32_t duration_ms;
+    uint8_t program;
+    uint8_t reserved[3];
+} SongLibraryEntry;
+
+typedef struct {
+    const uint16_t *pos;
+    uint16_t bpm;
+    int8_t transpose;
+    uint32_t base_ms;              // Tempo da música na última troca de andamento
+    uint32_t ticks;                // Tiques desde base_ms
+    struct {
+        const uint16_t *start;     // Primeira palavra do trecho
+        uint16_t left;             // Vezes que ainda falta repetir
+    } repeats[SONG_REPEAT_DEPTH];
+    uint8_t depth;
+} SongDecoder;
+
+// Tabela gerada pelo host/song_compiler (songs/song_table.c)
+extern const PackedSong compiled_songs[];
+extern const int compiled_song_count;
+
+extern void song_decoder_init(SongDecoder *d, const uint16_t *voice);
+extern bool song_decoder_next(SongDecoder *d, uint8_t *note, uint16_t *duration_ms);
+
+#endif
@@ -0,0 +1,60 @@
+#include "hardware/flash.h"
+#include "song_library.h"
+
+extern char __flash_binary_end;   // Fim do programa na flash (do linker script)
+
+static const SongLibraryHeader *header = NULL;
+
+static const uint8_t *image() {
+    return (const uint8_t *)(XIP_BASE + SONG_LIBRARY_OFFSET);
+}
+
+static const SongLibraryEntry *entries() {
+    return (const SongLibraryEntry *)(image() + sizeof(SongLibraryHeader));
+}
+
+// A voz deve caber na imagem, alinhada, e terminar em SONG_END
+static bool valid_voice(uint32_t offset, uint32_t words, uint32_t bytes) {
+    if (offset % 2 || words == 0 || offset > bytes || words > (bytes - offset) / 2)
+        return false;
+    const uint16_t *voice = (const uint16_t *)(image() + offset);
+    return voice[words - 1] == SONG_END;
+}
+
+// Confere a imagem uma vez (O(músicas)); depois cada música sai direto do
+// índice. Retorna quantas músicas há, 0 se não há biblioteca válida.
+int song_library_open() {
+    const SongLibraryHeader *h = (const SongLibraryHeader *)image();
+
+    header = NULL;
+    if ((const char *)image() < &__flash_binary_end)
+        return 0;   // O programa cresceu por cima da região
+    if (h->magic != SONG_LIBRARY_MAGIC || h->version != SONG_LIBRARY_VERSION || h->count == 0 ||
+        h->bytes > SONG_LIBRARY_BYTES ||
+        h->bytes < sizeof(SongLibraryHeader) + h->count * sizeof(SongLibraryEntry))
+        return 0;
+
+    for (int i = 0; i < h->count; i++) {
+        const SongLibraryEntry *e = &entries()[i];
+        if (!valid_voice(e->melody, e->melody_words, h->bytes))
+            return 0;
+        if (e->bass && !valid_voice(e->bass, e->bass_words, h->bytes))
+            return 0;
+    }
+    header = h;
+    return h->count;
+}
+
+// Música index da biblioteca aberta, com as vozes apontando para a XIP
+bool song_library_song(int index, PackedSong *song) {
+    if (!header || index < 0 || index >= header->count)
+        return false;
+
+    const SongLibraryEntry *e = &entries()[index];
+    song->title = e->title;
+    song->program = e->program;
+    song->melody = (const uint16_t *)(image() + e->melody);
+    song->bass = e->bass ? (const uint16_t *)(image() + e->bass) : NULL;
+    song->duration_ms = e->duration_ms;
+    return true;
+}
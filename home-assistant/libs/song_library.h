@@ -0,0 +1,19 @@
+#include "pico/stdlib.h"
+#include "song_format.h"
+#include "voice_clip.h"
+
+#ifndef song_library_inc_h
+#define song_library_inc_h
+
+// Biblioteca de músicas na flash, logo abaixo da região do recado de voz. A
+// imagem é gerada pelo host/song_compiler --library e gravada com o
+// picotool; o firmware só lê: o índice e as notas são acessados direto pela
+// XIP, sem cópia para a RAM. Escolher uma música é uma conta de endereço.
+
+#define SONG_LIBRARY_BYTES SONG_LIBRARY_MAX_BYTES
+#define SONG_LIBRARY_OFFSET (CLIP_FLASH_OFFSET - SONG_LIBRARY_BYTES)
+
+extern int song_library_open();
+extern bool song_library_song(int index, PackedSong *song);
+
+#endif
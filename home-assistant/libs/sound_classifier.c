@@ -0,0 +1,203 @@
+#include <string.h>
+#include "sound_classifier.h"
+
+// Bordas das bandas em bins de 62,5 Hz (espaçamento logarítmico)
+static const uint8_t band_edges[SOUND_FEATURE_DIMS + 1] = {
+    3, 4, 5, 6, 8, 10, 12, 15, 20, 25, 31, 40, 50, 63, 80, 101, 128,
+};
+
+void sound_classifier_init(SoundClassifier *c) {
+    memset(c, 0, sizeof(*c));
+    c->recording = -1;
+    spectrum_init();
+}
+
+// Vetor de uma janela sem DC; false se a janela está abaixo do limiar de energia
+bool sound_classifier_feature(const int16_t *window, SoundVector *out) {
+    static Complex16 bins[SPECTRUM_FFT_SIZE];
+    static uint32_t power[SPECTRUM_BINS];
+    uint16_t log_band[SOUND_FEATURE_DIMS];
+    uint64_t total = 0;
+    int32_t mean = 0;
+
+    spectrum_window(window, bins);
+    spectrum_fft(bins);
+    spectrum_power(bins, power);
+
+    for (int b = 0; b < SOUND_FEATURE_DIMS; b++) {
+        uint64_t energy = 0;
+        for (int k = band_edges[b]; k < band_edges[b + 1]; k++)
+            energy += power[k];
+        total += energy;
+        log_band[b] = log2_q8(energy + 1);
+        mean += log_band[b];
+    }
+    if (log2_q8(total) < SOUND_GATE_LOG2)
+        return false;
+
+    // Só a forma importa: tira a média dos logs (o ganho) e guarda em 1/8 de log2
+    mean /= SOUND_FEATURE_DIMS;
+    for (int b = 0; b < SOUND_FEATURE_DIMS; b++) {
+        int32_t v = (log_band[b] - mean) >> 5;
+        out->v[b] = v > 127 ? 127 : v < -128 ? -128 : v;
+    }
+    return true;
+}
+
+// Distância L1 entre dois vetores, interrompida quando passa de limit
+static uint32_t l1_distance(const int8_t *a, const int8_t *b, uint32_t limit) {
+    uint32_t d = 0;
+
+    for (int i = 0; i < SOUND_FEATURE_DIMS; i += 4) {
+        int32_t d0 = a[i] - b[i], d1 = a[i + 1] - b[i + 1];
+        int32_t d2 = a[i + 2] - b[i + 2], d3 = a[i + 3] - b[i + 3];
+        d += (d0 < 0 ? -d0 : d0) + (d1 < 0 ? -d1 : d1) + (d2 < 0 ? -d2 : d2) + (d3 < 0 ? -d3 : d3);
+        if (d >= limit)
+            break;
+    }
+    return d;
+}
+
+// Classe do exemplo mais próximo (-1 se o índice está vazio)
+int sound_index_nearest(const SoundIndex *index, const SoundVector *v, uint16_t *distance) {
+    uint32_t best = UINT32_MAX;
+    int label = -1;
+
+    for (int i = 0; i < index->count; i++) {
+        uint32_t d = l1_distance(index->examples[i].v, v->v, best);
+        if (d < best) {
+            best = d;
+            label = index->labels[i];
+        }
+    }
+    *distance = best > UINT16_MAX ? UINT16_MAX : best;
+    return label;
+}
+
+// Grava o próximo trecho com som como exemplo de label (-1 cancela)
+void sound_classifier_record(SoundClassifier *c, int label) {
+    c->recording = label >= 0 && label < SOUND_CLASSES ? label : -1;
+    c->recorded_windows = 0;
+    memset(c->record_sum, 0, sizeof(c->record_sum));
+}
+
+// Apaga todos os exemplos de uma classe
+void sound_classifier_forget(SoundClassifier *c, uint8_t label) {
+    SoundIndex *index = &c->index;
+    int kept = 0;
+
+    for (int i = 0; i < index->count; i++) {
+        if (index->labels[i] == label)
+            continue;
+        index->examples[kept] = index->examples[i];
+        index->labels[kept++] = index->labels[i];
+    }
+    index->count = kept;
+    index->stored[label] = 0;
+}
+
+// Guarda um exemplo; com a classe cheia, substitui o mais antigo dela
+static void store_example(SoundIndex *index, uint8_t label, const SoundVector *v) {
+    int slot = index->count, seen = 0;
+    int replace = index->stored[label] % SOUND_EXAMPLES;
+
+    for (int i = 0; i < index->count; i++) {
+        if (index->labels[i] == label && seen++ == replace && index->stored[label] >= SOUND_EXAMPLES) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == index->count) {
+        if (index->count >= SOUND_INDEX_SIZE)
+            return;
+        index->count++;
+    }
+    index->examples[slot] = *v;
+    index->labels[slot] = label;
+    index->stored[label]++;
+}
+
+// Média das últimas janelas com som
+static void average(const SoundClassifier *c, SoundVector *out) {
+    for (int b = 0; b < SOUND_FEATURE_DIMS; b++)
+        out->v[b] = (int8_t)(c->sum[b] / c->recent_count);
+}
+
+static SoundClassifierResult on_window(SoundClassifier *c, SoundMatch *match) {
+    SoundVector v;
+
+    if (!sound_classifier_feature(c->window, &v)) {
+        // Silêncio: esquece a média e rearma após SOUND_RELEASE_WINDOWS
+        c->recent_count = 0;
+        c->recent_pos = 0;
+        memset(c->sum, 0, sizeof(c->sum));
+        c->streak = 0;
+        if (c->quiet < SOUND_RELEASE_WINDOWS && ++c->quiet == SOUND_RELEASE_WINDOWS)
+            c->fired = false;
+        return SOUND_CLASSIFIER_NONE;
+    }
+    c->quiet = 0;
+
+    // Média móvel das últimas SOUND_AVERAGE_WINDOWS janelas
+    SoundVector *slot = &c->recent[c->recent_pos];
+    for (int b = 0; b < SOUND_FEATURE_DIMS; b++) {
+        if (c->recent_count == SOUND_AVERAGE_WINDOWS)
+            c->sum[b] -= slot->v[b];
+        c->sum[b] += v.v[b];
+    }
+    *slot = v;
+    c->recent_pos = (c->recent_pos + 1) % SOUND_AVERAGE_WINDOWS;
+    if (c->recent_count < SOUND_AVERAGE_WINDOWS)
+        c->recent_count++;
+
+    if (c->recording >= 0) {
+        for (int b = 0; b < SOUND_FEATURE_DIMS; b++)
+            c->record_sum[b] += v.v[b];
+        if (++c->recorded_windows < SOUND_RECORD_WINDOWS)
+            return SOUND_CLASSIFIER_NONE;
+
+        SoundVector example;
+        for (int b = 0; b < SOUND_FEATURE_DIMS; b++)
+            example.v[b] = (int8_t)(c->record_sum[b] / SOUND_RECORD_WINDOWS);
+        store_example(&c->index, c->recording, &example);
+        match->label = c->recording;
+        match->distance = 0;
+        c->recording = -1;
+        c->fired = true;  // Não reconhece o próprio som que acabou de gravar
+        return SOUND_CLASSIFIER_RECORDED;
+    }
+
+    if (c->index.count == 0 || c->fired || c->recent_count < SOUND_AVERAGE_WINDOWS)
+        return SOUND_CLASSIFIER_NONE;
+
+    SoundVector mean;
+    uint16_t distance;
+    average(c, &mean);
+    int label = sound_index_nearest(&c->index, &mean, &distance);
+
+    if (label < 0 || distance > SOUND_MATCH_DISTANCE) {
+        c->streak = 0;
+        return SOUND_CLASSIFIER_NONE;
+    }
+    c->streak = label == c->last_label ? c->streak + 1 : 1;
+    c->last_label = label;
+    if (c->streak < SOUND_MATCH_CONFIRM)
+        return SOUND_CLASSIFIER_NONE;
+
+    c->fired = true;
+    match->label = label;
+    match->distance = distance;
+    return SOUND_CLASSIFIER_MATCH;
+}
+
+// Consome um bloco sem DC (n divide SPECTRUM_FFT_SIZE); analisa a janela
+// quando ela completa
+SoundClassifierResult sound_classifier_process(SoundClassifier *c, const int16_t *x, int n, SoundMatch *match) {
+    memcpy(c->window + c->fill, x, n * sizeof(int16_t));
+    c->fill += n;
+    if (c->fill < SPECTRUM_FFT_SIZE)
+        return SOUND_CLASSIFIER_NONE;
+
+    c->fill = 0;
+    return on_window(c, match);
+}
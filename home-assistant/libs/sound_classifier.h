@@ -0,0 +1,67 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "spectrum.h"
+
+#ifndef sound_classifier_inc_h
+#define sound_classifier_inc_h
+
+// Classificador ensinado por exemplos: cada janela de SPECTRUM_FFT_SIZE
+// amostras vira um vetor int8 com a forma do espectro (16 bandas em log2,
+// sem o ganho), a média de algumas janelas é comparada por vizinho mais
+// próximo (distância L1) com os exemplos gravados de cada classe.
+
+#define SOUND_FEATURE_DIMS 16        // Bandas logarítmicas de ~190 Hz a 8 kHz
+#define SOUND_CLASSES 4              // Sons que podem ser ensinados
+#define SOUND_EXAMPLES 3             // Exemplos guardados por classe
+#define SOUND_INDEX_SIZE (SOUND_CLASSES * SOUND_EXAMPLES)
+#define SOUND_AVERAGE_WINDOWS 8      // Janelas na média comparada (128 ms a 16 kHz)
+#define SOUND_RECORD_WINDOWS 32      // Janelas com som para gravar um exemplo (~0,5 s)
+#define SOUND_GATE_LOG2 (14 * 256)   // Energia mínima (log2 Q8): ~40 contagens RMS
+#define SOUND_MATCH_DISTANCE 192     // Distância L1 máxima para reconhecer
+#define SOUND_MATCH_CONFIRM 3        // Janelas seguidas com a mesma classe
+#define SOUND_RELEASE_WINDOWS 8      // Janelas em silêncio para rearmar a classe
+
+typedef struct {
+    int8_t v[SOUND_FEATURE_DIMS];    // log2 da banda - média, em 1/8 de log2
+} SoundVector;
+
+typedef struct {
+    SoundVector examples[SOUND_INDEX_SIZE];
+    uint8_t labels[SOUND_INDEX_SIZE];
+    uint8_t count;
+    uint8_t stored[SOUND_CLASSES];   // Exemplos gravados por classe (total, sem limite)
+} SoundIndex;
+
+typedef enum {
+    SOUND_CLASSIFIER_NONE,
+    SOUND_CLASSIFIER_MATCH,          // Um som ensinado foi reconhecido
+    SOUND_CLASSIFIER_RECORDED        // Um exemplo terminou de ser gravado
+} SoundClassifierResult;
+
+typedef struct {
+    uint8_t label;
+    uint16_t distance;
+} SoundMatch;
+
+typedef struct {
+    SoundIndex index;
+    int16_t window[SPECTRUM_FFT_SIZE] __attribute__((aligned(4)));
+    uint16_t fill;
+    SoundVector recent[SOUND_AVERAGE_WINDOWS];
+    int16_t sum[SOUND_FEATURE_DIMS]; // Soma das janelas em recent
+    uint8_t recent_pos, recent_count;
+    int8_t recording;                // Classe em gravação (-1: nenhuma)
+    uint8_t recorded_windows;
+    int32_t record_sum[SOUND_FEATURE_DIMS];
+    uint8_t last_label, streak, quiet;
+    bool fired;                      // Já reconhecido neste trecho de som
+} SoundClassifier;
+
+extern void sound_classifier_init(SoundClassifier *c);
+extern void sound_classifier_record(SoundClassifier *c, int label);
+extern void sound_classifier_forget(SoundClassifier *c, uint8_t label);
+extern SoundClassifierResult sound_classifier_process(SoundClassifier *c, const int16_t *x, int n, SoundMatch *match);
+extern bool sound_classifier_feature(const int16_t *window, SoundVector *out);
+extern int sound_index_nearest(const SoundIndex *index, const SoundVector *v, uint16_t *distance);
+
+#endif
@@ -0,0 +1,233 @@
+#include <string.h>
+#include "sound_detector.h"
+
+// Converte milissegundos em amostras
+static uint32_t ms_to_samples(const SoundDetectorConfig *config, uint32_t ms) {
+    return ms * config->sample_rate / 1000;
+}
+
+// Deslocamento cuja constante de tempo (2^shift amostras) mais se aproxima de ms
+static uint8_t shift_for_ms(const SoundDetectorConfig *config, uint32_t ms) {
+    uint32_t samples = ms_to_samples(config, ms);
+    uint8_t shift = 0;
+
+    while ((2u << shift) <= samples)
+        shift++;
+    return shift;
+}
+
+void sound_detector_default_config(SoundDetectorConfig *config, uint32_t sample_rate) {
+    config->sample_rate = sample_rate;
+    config->onset_ratio = 12;  // Envoltória rápida 3x acima do fundo
+    config->clap_level = CLAP_THRESHOLD;
+    config->noise_level = NOISE_THRESHOLD;
+    config->noise_hold_ms = 150;
+    config->clap_decay_ms = 60;
+    config->refractory_ms = 100;
+    config->gap_min_ms = 200;
+    config->gap_max_ms = 1000;
+    config->use_spectrum = true;
+    config->adaptive = true;
+    config->calibration_ms = 256;
+    config->clap_sigma = 8;
+    config->noise_sigma = 16;
+}
+
+void sound_detector_init(SoundDetector *detector, const SoundDetectorConfig *config) {
+    detector->config = *config;
+
+    dsp_envelope_init(&detector->fast, 1, shift_for_ms(config, 4));
+    dsp_envelope_init(&detector->slow, shift_for_ms(config, 128), shift_for_ms(config, 128));
+
+    detector->refractory = ms_to_samples(config, config->refractory_ms);
+    detector->decay = ms_to_samples(config, config->clap_decay_ms);
+    detector->gap_min = ms_to_samples(config, config->gap_min_ms);
+    detector->gap_max = ms_to_samples(config, config->gap_max_ms);
+    detector->noise_hold = ms_to_samples(config, config->noise_hold_ms);
+
+    detector->state = CLAP_IDLE;
+    detector->first_clap = 0;
+    detector->last_onset = 0u - detector->refractory;
+    detector->onset_peak = 0;
+    detector->noise_start = 0;
+    detector->noise_active = false;
+    detector->noise_fired = false;
+    detector->clap_class = SOUND_CLASS_UNKNOWN;
+    memset(detector->history, 0, sizeof(detector->history));
+    detector->history_pos = 0;
+
+    dsp_floor_init(&detector->floor);
+    detector->floor_sum = 0;
+    detector->floor_ticks = 0;
+    detector->calibration = config->adaptive
+        ? ms_to_samples(config, config->calibration_ms) / (SOUND_SUB_BLOCK * SOUND_FLOOR_SUB_BLOCKS)
+        : 0;
+    detector->clap_level = config->clap_level;
+    detector->noise_level = config->noise_level;
+    spectrum_init();
+}
+
+// Fundo já medido: antes disso nenhum evento é emitido
+bool sound_detector_calibrated(const SoundDetector *detector) {
+    return detector->floor.count >= detector->calibration;
+}
+
+// Recalcula os limiares a partir da média e do desvio do fundo. Os mínimos
+// da configuração valem em ambiente silencioso e também limitam a margem
+// k·σ: numa sala com conversa o desvio cresce muito, e sem esse limite os
+// limiares passavam do fundo de escala, desligando a detecção. O som alto
+// fica sempre ao menos 50% acima da palma para que as duas não se confundam.
+static void update_levels(SoundDetector *d) {
+    const SoundDetectorConfig *config = &d->config;
+    uint32_t mean = dsp_floor_mean(&d->floor);
+    uint32_t deviation = dsp_floor_deviation(&d->floor);
+    uint32_t clap_margin = config->clap_sigma * deviation;
+    uint32_t noise_margin = config->noise_sigma * deviation;
+
+    if (clap_margin > config->clap_level)
+        clap_margin = config->clap_level;
+    if (noise_margin > config->noise_level)
+        noise_margin = config->noise_level;
+
+    uint32_t clap = mean + clap_margin;
+    uint32_t noise = mean + noise_margin;
+    if (clap < config->clap_level)
+        clap = config->clap_level;
+    if (noise < config->noise_level)
+        noise = config->noise_level;
+    if (noise < clap + clap / 2)
+        noise = clap + clap / 2;
+
+    d->noise_level = noise > SOUND_MAX_NOISE_LEVEL ? SOUND_MAX_NOISE_LEVEL : noise;
+    d->clap_level = clap > d->noise_level * 2 / 3 ? d->noise_level * 2 / 3 : clap;
+}
+
+// Acumula a envoltória rápida numa medida do fundo a cada SOUND_FLOOR_SUB_BLOCKS.
+// Trechos com evento em andamento (palma decaindo, som alto) não entram na
+// janela, senão o próprio evento elevaria os limiares.
+static void track_floor(SoundDetector *d, uint16_t fast, uint32_t t) {
+    bool quiet = !d->noise_active && d->state != CLAP_DECAY && t - d->last_onset >= d->refractory;
+
+    if (!quiet) {
+        d->floor_sum = 0;
+        d->floor_ticks = 0;
+        return;
+    }
+    d->floor_sum += fast;
+    if (++d->floor_ticks < SOUND_FLOOR_SUB_BLOCKS)
+        return;
+
+    dsp_floor_push(&d->floor, (uint16_t)(d->floor_sum / SOUND_FLOOR_SUB_BLOCKS));
+    d->floor_sum = 0;
+    d->floor_ticks = 0;
+    if (sound_detector_calibrated(d))
+        update_levels(d);
+}
+
+// Classifica as últimas SPECTRUM_FFT_SIZE amostras pela forma do espectro
+static uint8_t classify_history(SoundDetector *d, bool impulsive) {
+    static int16_t window[SPECTRUM_FFT_SIZE];
+    int tail = SPECTRUM_FFT_SIZE - d->history_pos;
+
+    // Reordena o histórico circular da amostra mais antiga para a mais recente
+    memcpy(window, d->history + d->history_pos, tail * sizeof(int16_t));
+    memcpy(window + tail, d->history, d->history_pos * sizeof(int16_t));
+
+    spectrum_analyze(window, d->config.sample_rate, &d->features);
+    return spectrum_classify(&d->features, impulsive);
+}
+
+// Máquina de estados da sequência de palmas diante de um novo início
+static int on_onset(SoundDetector *d, uint32_t t, uint16_t fast, SoundEvent *events, int count, int max_events) {
+    switch (d->state) {
+        case CLAP_WAIT: {
+            uint32_t gap = t - d->first_clap;
+            if (gap < d->gap_min)
+                return count; // Cedo demais: eco ou a mesma palma
+            if (gap <= d->gap_max) {
+                if (count < max_events)
+                    events[count++] = (SoundEvent){SOUND_EVENT_DOUBLE_CLAP, t, fast, d->clap_class};
+                d->state = CLAP_IDLE;
+                return count;
+            }
+        }
+        // Fora da janela: este início passa a ser a primeira palma
+        // fall through
+        case CLAP_IDLE:
+        case CLAP_DECAY:
+            d->state = CLAP_DECAY;
+            d->first_clap = t;
+            d->onset_peak = fast;
+            break;
+    }
+    return count;
+}
+
+// Processa um bloco sem DC (n múltiplo de SOUND_SUB_BLOCK) cuja primeira
+// amostra é start_sample; escreve até max_events eventos e retorna quantos
+int sound_detector_process(SoundDetector *d, const int16_t *x, int n,
+                           uint32_t start_sample, SoundEvent *events, int max_events) {
+    const SoundDetectorConfig *config = &d->config;
+    int count = 0;
+
+    for (int i = 0; i < n; i += SOUND_SUB_BLOCK) {
+        uint16_t fast = dsp_envelope(&d->fast, x + i, SOUND_SUB_BLOCK);
+        uint16_t slow = dsp_envelope(&d->slow, x + i, SOUND_SUB_BLOCK);
+        uint32_t t = start_sample + i + SOUND_SUB_BLOCK;
+
+        memcpy(d->history + d->history_pos, x + i, SOUND_SUB_BLOCK * sizeof(int16_t));
+        d->history_pos = (d->history_pos + SOUND_SUB_BLOCK) % SPECTRUM_FFT_SIZE;
+
+        if (config->adaptive) {
+            track_floor(d, fast, t);
+            if (!sound_detector_calibrated(d))
+                continue;
+        }
+
+        // Som alto: envoltória acima do limiar por noise_hold, com histerese
+        if (fast >= d->noise_level) {
+            if (!d->noise_active) {
+                d->noise_active = true;
+                d->noise_start = t;
+            }
+            if (!d->noise_fired && t - d->noise_start >= d->noise_hold) {
+                uint8_t sound_class = config->use_spectrum ? classify_history(d, false) : SOUND_CLASS_UNKNOWN;
+                if (count < max_events)
+                    events[count++] = (SoundEvent){SOUND_EVENT_LOUD_NOISE, t, fast, sound_class};
+                d->noise_fired = true;
+                d->state = CLAP_IDLE;
+            }
+        } else if (fast < d->noise_level / 2) {
+            d->noise_active = false;
+            d->noise_fired = false;
+        }
+
+        // Início: envoltória rápida bem acima do fundo, fora do período refratário
+        if (fast >= d->clap_level
+            && (uint32_t)fast * 4 > (uint32_t)slow * config->onset_ratio
+            && t - d->last_onset >= d->refractory
+            && !d->noise_fired) {
+            d->last_onset = t;
+            if (count < max_events)
+                events[count++] = (SoundEvent){SOUND_EVENT_ONSET, t, fast, SOUND_CLASS_UNKNOWN};
+            count = on_onset(d, t, fast, events, count, max_events);
+            continue;
+        }
+
+        // Uma palma é impulsiva: precisa cair à metade do pico em clap_decay_ms
+        if (d->state == CLAP_DECAY) {
+            if (fast > d->onset_peak)
+                d->onset_peak = fast;
+            if (fast <= d->onset_peak / 2) {
+                // Palmas são de banda larga; um início tonal (bipe, apito) é descartado
+                d->clap_class = config->use_spectrum ? classify_history(d, true) : SOUND_CLASS_IMPULSE;
+                d->state = d->clap_class == SOUND_CLASS_TONAL ? CLAP_IDLE : CLAP_WAIT;
+            }
+            else if (t - d->first_clap > d->decay)
+                d->state = CLAP_IDLE;
+        } else if (d->state == CLAP_WAIT && t - d->first_clap > d->gap_max) {
+            d->state = CLAP_IDLE;
+        }
+    }
+    return count;
+}
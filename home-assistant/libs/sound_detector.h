@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "audio_dsp.h"
+#include "spectrum.h"
+
+#ifndef sound_detector_inc_h
+#define sound_detector_inc_h
+
+// Limiares mínimos em contagens do ADC (amplitude sem o nível DC). Com a
+// calibração ligada os limiares efetivos sobem com o fundo medido, nunca
+// abaixo destes valores.
+#define CLAP_THRESHOLD 500    // Nível mínimo da envoltória rápida para uma palma
+#define NOISE_THRESHOLD 1450  // Nível sustentado que caracteriza som alto
+#define SOUND_FULL_SCALE 2047 // Maior amplitude do ADC de 12 bits sem o nível DC
+#define SOUND_MAX_NOISE_LEVEL (SOUND_FULL_SCALE * 3 / 4) // Teto dos limiares calibrados
+
+#define SOUND_SUB_BLOCK 16       // Resolução da detecção (1 ms a 16 kHz)
+#define SOUND_FLOOR_SUB_BLOCKS 4 // Sub-blocos por medida do fundo (janela de ~1 s)
+#define SOUND_MAX_EVENTS 8       // Eventos por bloco no pior caso
+
+typedef enum {
+    SOUND_EVENT_ONSET,        // Início de som impulsivo (candidato a palma)
+    SOUND_EVENT_DOUBLE_CLAP,  // Duas palmas dentro da janela de tempo
+    SOUND_EVENT_LOUD_NOISE,   // Som alto sustentado
+    SOUND_EVENT_KEYWORD,      // Palavra-chave (level = logit, sound_class = KwsLabel)
+    SOUND_EVENT_LEARNED,      // Som ensinado reconhecido (level = distância, sound_class = classe)
+    SOUND_EVENT_RECORDED,     // Exemplo gravado no modo de ensino (sound_class = classe)
+    SOUND_EVENT_RHYTHM,       // Código rítmico reconhecido (level = desvio, sound_class = código)
+    SOUND_EVENT_RHYTHM_RECORDED // Código rítmico gravado (sound_class = código)
+} SoundEventType;
+
+typedef struct {
+    SoundEventType type;
+    uint32_t sample;  // Índice da amostra (no fluxo do microfone) do evento
+    uint16_t level;   // Envoltória rápida no momento do evento
+    uint8_t sound_class; // SoundClass pela forma do espectro (palmas e som alto)
+} SoundEvent;
+
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t onset_ratio;       // Rápida > lenta * ratio / 4 caracteriza um início
+    uint16_t clap_level;       // Nível mínimo da envoltória rápida para uma palma
+    uint16_t noise_level;      // Nível sustentado mínimo de ruído alto
+    uint16_t noise_hold_ms;    // Tempo acima de noise_level para disparar o alarme
+    uint16_t clap_decay_ms;    // Uma palma deve decair para metade neste tempo
+    uint16_t refractory_ms;    // Ignora novos inícios após um início
+    uint16_t gap_min_ms;       // Intervalo mínimo entre as duas palmas
+    uint16_t gap_max_ms;       // Intervalo máximo entre as duas palmas
+    bool use_spectrum;         // Rejeita palmas tonais e classifica o som alto
+    bool adaptive;             // Ajusta os limiares ao fundo (clap_level e noise_level viram mínimos)
+    uint16_t calibration_ms;   // Escuta inicial do fundo, sem eventos
+    uint8_t clap_sigma;        // Palma: fundo + clap_sigma desvios padrão
+    uint8_t noise_sigma;       // Som alto: fundo + noise_sigma desvios padrão
+} SoundDetectorConfig;
+
+typedef enum {
+    CLAP_IDLE,      // Esperando a primeira palma
+    CLAP_DECAY,     // Primeira palma detectada, esperando o decaimento
+    CLAP_WAIT       // Palma confirmada, esperando a segunda
+} ClapState;
+
+typedef struct {
+    SoundDetectorConfig config;
+    Envelope fast;             // Envoltória rápida (~4 ms de liberação)
+    Envelope slow;             // Envoltória lenta do fundo (~128 ms)
+    ClapState state;
+    uint32_t first_clap;       // Amostra da primeira palma
+    uint32_t last_onset;       // Amostra do último início aceito
+    uint16_t onset_peak;       // Pico da envoltória após o início
+    uint32_t noise_start;      // Início do trecho acima de noise_level
+    bool noise_active;         // Trecho alto em andamento
+    bool noise_fired;          // Alarme já emitido neste trecho
+    uint32_t refractory;       // Duração do período refratário em amostras
+    uint32_t decay;            // Tempo de decaimento da palma em amostras
+    uint32_t gap_min, gap_max; // Janela da segunda palma em amostras
+    uint32_t noise_hold;       // Duração mínima do ruído alto em amostras
+    uint8_t clap_class;        // Classe espectral da primeira palma
+    int16_t history[SPECTRUM_FFT_SIZE]; // Últimas amostras para a análise espectral
+    uint16_t history_pos;
+    SpectralFeatures features; // Características da última análise
+    NoiseFloor floor;          // Janela deslizante do nível de fundo
+    uint32_t floor_sum;        // Soma da envoltória rápida na medida em curso
+    uint8_t floor_ticks;       // Sub-blocos acumulados na medida em curso
+    uint16_t calibration;      // Medidas necessárias antes de emitir eventos
+    uint16_t clap_level;       // Limiar efetivo da palma
+    uint16_t noise_level;      // Limiar efetivo do som alto
+} SoundDetector;
+
+extern void sound_detector_default_config(SoundDetectorConfig *config, uint32_t sample_rate);
+extern void sound_detector_init(SoundDetector *detector, const SoundDetectorConfig *config);
+extern int sound_detector_process(SoundDetector *detector, const int16_t *x, int n,
+                                  uint32_t start_sample, SoundEvent *events, int max_events);
+extern bool sound_detector_calibrated(const SoundDetector *detector);
+
+#endif
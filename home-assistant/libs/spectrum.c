@@ -0,0 +1,230 @@
+#include "spectrum.h"
+#include "cycle_counter.h"
+
+#define N SPECTRUM_FFT_SIZE
+
+#if SPECTRUM_FFT_SIZE != 256
+#error "As tabelas de cosseno assumem FFT de 256 pontos"
+#endif
+
+// cos(2 pi k / 256) em Q15 para k = 0..128 (meio ciclo; o resto por simetria)
+static const int16_t cos_table[129] = {
+    32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285, 32137, 31971, 31785, 31580,
+    31356, 31113, 30852, 30571, 30273, 29956, 29621, 29268, 28898, 28510, 28105, 27683,
+    27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731, 23170, 22594, 22005, 21403,
+    20787, 20159, 19519, 18868, 18204, 17530, 16846, 16151, 15446, 14732, 14010, 13279,
+    12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179, 6393, 5602, 4808, 4011,
+    3212, 2410, 1608, 804, 0, -804, -1608, -2410, -3212, -4011, -4808, -5602,
+    -6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793, -12539, -13279, -14010, -14732,
+    -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790, -27245, -27683, -28105, -28510,
+    -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+    -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757, -32767,
+};
+
+// log2(1 + i/16) e 2^(-i/16) em Q8
+static const uint8_t log2_frac[16] = {0, 22, 44, 63, 82, 100, 118, 134, 150, 165, 179, 193, 207, 220, 232, 244};
+static const uint16_t exp2_frac[16] = {256, 245, 235, 225, 215, 206, 197, 189, 181, 173, 166, 159, 152, 146, 140, 134};
+
+// Limites das bandas em bins (oitavas, com as duas últimas divididas ao meio)
+static const uint8_t band_edges[SPECTRUM_BANDS + 1] = {
+    1, SPECTRUM_BINS / 64, SPECTRUM_BINS / 32, SPECTRUM_BINS / 16, SPECTRUM_BINS / 8,
+    SPECTRUM_BINS / 4, SPECTRUM_BINS / 2, 3 * SPECTRUM_BINS / 4, SPECTRUM_BINS,
+};
+
+static uint8_t bit_reverse[N];
+static SpectrumStats stats;
+
+// cos(2 pi i / 256) para qualquer índice
+static inline int32_t cos_at(int i) {
+    i &= 255;
+    return cos_table[i > 128 ? 256 - i : i];
+}
+
+void spectrum_init() {
+    for (int i = 0; i < N; i++) {
+        int r = 0;
+        for (int b = 0; b < SPECTRUM_FFT_LOG2; b++)
+            r |= ((i >> b) & 1) << (SPECTRUM_FFT_LOG2 - 1 - b);
+        bit_reverse[i] = r;
+    }
+}
+
+// Aplica a janela de Hann (amostras de 12 bits escaladas para Q15) e já
+// grava em ordem bit-reversa, como a FFT espera
+void spectrum_window(const int16_t *x, Complex16 *out) {
+    uint32_t start = cycle_counter_now();
+
+    for (int i = 0; i < N; i++) {
+        int32_t hann = (32768 - cos_at(i * 256 / N)) >> 1;
+        Complex16 *c = &out[bit_reverse[i]];
+        c->re = (int16_t)(((int32_t)x[i] * 8 * hann) >> 15);
+        c->im = 0;
+    }
+    stats.window = cycle_counter_elapsed(start);
+}
+
+// FFT de decimação no tempo, in-place, com entrada em ordem bit-reversa.
+// Os dois primeiros estágios são uma borboleta radix-4 (fatores +-1, -j, sem
+// multiplicações); os demais são radix-2. Cada estágio divide por 2, então a
+// saída vem escalada por 1/N e nunca satura.
+void spectrum_fft(Complex16 *x) {
+    uint32_t start = cycle_counter_now();
+
+    for (int i = 0; i < N; i += 4) {
+        int32_t s0r = x[i].re + x[i + 1].re, s0i = x[i].im + x[i + 1].im;
+        int32_t d0r = x[i].re - x[i + 1].re, d0i = x[i].im - x[i + 1].im;
+        int32_t s1r = x[i + 2].re + x[i + 3].re, s1i = x[i + 2].im + x[i + 3].im;
+        int32_t d1r = x[i + 2].re - x[i + 3].re, d1i = x[i + 2].im - x[i + 3].im;
+
+        x[i].re = (s0r + s1r) >> 2;     x[i].im = (s0i + s1i) >> 2;
+        x[i + 2].re = (s0r - s1r) >> 2; x[i + 2].im = (s0i - s1i) >> 2;
+        x[i + 1].re = (d0r + d1i) >> 2; x[i + 1].im = (d0i - d1r) >> 2;
+        x[i + 3].re = (d0r - d1i) >> 2; x[i + 3].im = (d0i + d1r) >> 2;
+    }
+
+    for (int span = 4; span < N; span <<= 1) {
+        int step = N / (2 * span);
+        for (int k = 0; k < span; k++) {
+            int32_t wr = cos_at(k * step);
+            int32_t wi = -cos_at(N / 4 - k * step); // -sin
+            for (int i = k; i < N; i += 2 * span) {
+                Complex16 *a = &x[i], *b = &x[i + span];
+                int32_t tr = (b->re * wr - b->im * wi) >> 15;
+                int32_t ti = (b->re * wi + b->im * wr) >> 15;
+                b->re = (a->re - tr) >> 1; b->im = (a->im - ti) >> 1;
+                a->re = (a->re + tr) >> 1; a->im = (a->im + ti) >> 1;
+            }
+        }
+    }
+    stats.fft = cycle_counter_elapsed(start);
+}
+
+// Potência |X|^2 dos bins 0..N/2-1
+void spectrum_power(const Complex16 *x, uint32_t *power) {
+    uint32_t start = cycle_counter_now();
+
+    for (int k = 0; k < SPECTRUM_BINS; k++)
+        power[k] = (uint32_t)(x[k].re * x[k].re) + (uint32_t)(x[k].im * x[k].im);
+    stats.power = cycle_counter_elapsed(start);
+}
+
+// log2(x) em Q8 (0 para x = 0), via contagem de zeros e tabela de 4 bits
+uint16_t log2_q8(uint64_t x) {
+    if (x == 0)
+        return 0;
+
+    int msb = 63 - __builtin_clzll(x);
+    int frac = (int)((x << (63 - msb)) >> 59) & 15;
+    return (uint16_t)(msb * 256 + log2_frac[frac]);
+}
+
+// Energias por banda, centroide e planicidade a partir do espectro de potência
+void spectrum_features(const uint32_t *power, uint32_t sample_rate, SpectralFeatures *features) {
+    uint32_t start = cycle_counter_now();
+    uint64_t total = 0, weighted = 0, high = 0;
+    uint32_t sum_log = 0;
+
+    for (int b = 0; b < SPECTRUM_BANDS; b++) {
+        uint64_t band = 0;
+        for (int k = band_edges[b]; k < band_edges[b + 1]; k++) {
+            band += power[k];
+            weighted += (uint64_t)power[k] * k;
+            sum_log += log2_q8((uint64_t)power[k] + 1);
+        }
+        features->band_energy[b] = log2_q8(band);
+        total += band;
+        if (b >= SPECTRUM_BANDS - 2)  // As duas últimas bandas vão de fs/4 a fs/2
+            high += band;
+    }
+    features->total_energy = log2_q8(total);
+
+    const int bins = SPECTRUM_BINS - 1;
+    if (total == 0) {
+        features->centroid_hz = 0;
+        features->flatness = 0;
+        features->high_share = 0;
+    } else {
+        features->high_share = (uint8_t)(high * 255 / total);
+        uint32_t centroid_q8 = (uint32_t)((weighted << 8) / total);
+        features->centroid_hz = (uint16_t)(((uint64_t)centroid_q8 * sample_rate / N) >> 8);
+
+        // Planicidade = 2^(média dos logs - log da média)
+        int32_t diff = log2_q8(total / bins + 1) - (int32_t)(sum_log / bins);
+        if (diff < 0)
+            diff = 0;
+        uint32_t flat = diff >= 16 * 256 ? 0 : exp2_frac[(diff >> 4) & 15] >> (diff >> 8);
+        features->flatness = flat > 255 ? 255 : flat;
+    }
+    stats.features = cycle_counter_elapsed(start);
+}
+
+// Janela + FFT + características de N amostras sem DC
+void spectrum_analyze(const int16_t *x, uint32_t sample_rate, SpectralFeatures *features) {
+    static Complex16 bins[N];
+    static uint32_t power[SPECTRUM_BINS];
+
+    spectrum_window(x, bins);
+    spectrum_fft(bins);
+    spectrum_power(bins, power);
+    spectrum_features(power, sample_rate, features);
+}
+
+// Classifica a forma do espectro
+SoundClass spectrum_classify(const SpectralFeatures *features, bool impulsive) {
+    if (features->total_energy == 0)
+        return SOUND_CLASS_UNKNOWN;
+    if (features->flatness < 40)
+        return SOUND_CLASS_TONAL;
+    // Palma é ruído quase branco: centroide perto de fs/4, então o teste de
+    // impulso vem antes do de agudos
+    if (impulsive && features->flatness >= 64)
+        return SOUND_CLASS_IMPULSE;
+    if (features->high_share >= 192)
+        return SOUND_CLASS_HIGH;
+    return SOUND_CLASS_BROADBAND;
+}
+
+// Prepara filtros de Goertzel nas frequências pedidas
+void goertzel_bank_init(GoertzelBank *bank, const uint16_t *freqs_hz, int count, uint32_t sample_rate) {
+    if (count > GOERTZEL_MAX)
+        count = GOERTZEL_MAX;
+
+    for (int i = 0; i < count; i++) {
+        // Fase por amostra em unidades de 1/256 de ciclo, Q8; cos interpolado
+        uint32_t phase = ((uint32_t)freqs_hz[i] << 16) / sample_rate;
+        int idx = phase >> 8, frac = phase & 255;
+        int32_t c0 = cos_at(idx), c1 = cos_at(idx + 1);
+
+        // 2 cos(w) em Q14 tem o mesmo valor inteiro que cos(w) em Q15
+        bank->filters[i].coeff = (int16_t)(c0 + (((c1 - c0) * frac) >> 8));
+        bank->filters[i].freq_hz = freqs_hz[i];
+    }
+    bank->count = count;
+}
+
+// Potência (log2, Q8) de cada filtro sobre um bloco sem DC
+void goertzel_bank_process(const GoertzelBank *bank, const int16_t *x, int n, uint16_t *log_power) {
+    uint32_t start = cycle_counter_now();
+
+    for (int f = 0; f < bank->count; f++) {
+        const int32_t coeff = bank->filters[f].coeff;
+        int32_t s1 = 0, s2 = 0;
+
+        // Entrada reduzida a 8 bits para que coeff * s caiba em 32 bits (n <= 256)
+        for (int i = 0; i < n; i += 2) {
+            int32_t s0 = (x[i] >> 4) + ((coeff * s1) >> 14) - s2;
+            s2 = (x[i + 1] >> 4) + ((coeff * s0) >> 14) - s1;
+            s1 = s2;
+            s2 = s0;
+        }
+
+        int64_t power = (int64_t)s1 * s1 + (int64_t)s2 * s2 - (((int64_t)coeff * s1 * s2) >> 14);
+        log_power[f] = log2_q8(power > 0 ? (uint64_t)power : 0);
+    }
+    stats.goertzel = cycle_counter_elapsed(start);
+}
+
+const SpectrumStats *spectrum_stats() {
+    return &stats;
+}
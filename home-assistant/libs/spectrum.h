@@ -0,0 +1,69 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef spectrum_inc_h
+#define spectrum_inc_h
+
+// Análise espectral em ponto fixo (Q15) para o fluxo do microfone
+
+#define SPECTRUM_FFT_LOG2 8
+#define SPECTRUM_FFT_SIZE (1 << SPECTRUM_FFT_LOG2) // 256 pontos (16 ms a 16 kHz)
+#define SPECTRUM_BINS (SPECTRUM_FFT_SIZE / 2)
+#define SPECTRUM_BANDS 8   // Bandas em oitavas até a frequência de Nyquist
+#define GOERTZEL_MAX 8     // Filtros no banco de Goertzel
+
+typedef struct {
+    int16_t re, im;
+} Complex16;
+
+// Características espectrais de uma janela (energias em log2, Q8)
+typedef struct {
+    uint16_t total_energy;            // log2 da soma das potências
+    uint16_t band_energy[SPECTRUM_BANDS];
+    uint16_t centroid_hz;             // Centro de massa do espectro
+    uint8_t flatness;                 // Média geométrica / aritmética (255 = ruído branco)
+    uint8_t high_share;               // Fração da energia acima de fs/4 (255 = toda; ruído branco ~128)
+} SpectralFeatures;
+
+typedef struct {
+    int16_t coeff;       // 2 cos(2 pi f / fs) em Q14
+    uint16_t freq_hz;
+} GoertzelFilter;
+
+typedef struct {
+    GoertzelFilter filters[GOERTZEL_MAX];
+    uint8_t count;
+} GoertzelBank;
+
+// Custo do último bloco processado por kernel (ciclos no RP2040, ns no host)
+typedef struct {
+    uint32_t window;
+    uint32_t fft;
+    uint32_t power;
+    uint32_t features;
+    uint32_t goertzel;
+} SpectrumStats;
+
+typedef enum {
+    SOUND_CLASS_UNKNOWN,
+    SOUND_CLASS_IMPULSE,    // Impulsivo e de banda larga (palma, batida)
+    SOUND_CLASS_TONAL,      // Energia concentrada em poucos tons (alarme, campainha)
+    SOUND_CLASS_HIGH,       // Banda larga com 3/4 da energia acima de fs/4 (vidro quebrando)
+    SOUND_CLASS_BROADBAND   // Ruído sustentado de banda larga
+} SoundClass;
+
+extern void spectrum_init();
+extern void spectrum_window(const int16_t *x, Complex16 *out);
+extern void spectrum_fft(Complex16 *x);
+extern void spectrum_power(const Complex16 *x, uint32_t *power);
+extern void spectrum_features(const uint32_t *power, uint32_t sample_rate, SpectralFeatures *features);
+extern void spectrum_analyze(const int16_t *x, uint32_t sample_rate, SpectralFeatures *features);
+extern SoundClass spectrum_classify(const SpectralFeatures *features, bool impulsive);
+
+extern void goertzel_bank_init(GoertzelBank *bank, const uint16_t *freqs_hz, int count, uint32_t sample_rate);
+extern void goertzel_bank_process(const GoertzelBank *bank, const int16_t *x, int n, uint16_t *log_power);
+
+extern uint16_t log2_q8(uint64_t x);
+extern const SpectrumStats *spectrum_stats();
+
+#endif
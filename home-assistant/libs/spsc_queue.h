@@ -0,0 +1,72 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef spsc_queue_inc_h
+#define spsc_queue_inc_h
+
+// Fila circular sem travas para um produtor e um consumidor (ex.: core1 ->
+// core0, ou interrupção -> laço principal). O produtor só escreve head e o
+// consumidor só escreve tail; a barreira de memória garante que o item já
+// está na memória antes de o índice o publicar.
+
+typedef struct {
+    volatile uint32_t head;    // Próxima posição de escrita (produtor)
+    volatile uint32_t tail;    // Próxima posição de leitura (consumidor)
+    volatile uint32_t dropped; // Itens descartados com a fila cheia
+    uint32_t capacity;         // Potência de 2
+    uint32_t item_size;
+    uint8_t *items;
+} SpscQueue;
+
+static inline void spsc_init(SpscQueue *q, void *items, uint32_t item_size, uint32_t capacity) {
+    q->head = 0;
+    q->tail = 0;
+    q->dropped = 0;
+    q->capacity = capacity;
+    q->item_size = item_size;
+    q->items = (uint8_t *)items;
+}
+
+// Chamado só pelo produtor; retorna false (e conta o descarte) se estiver cheia
+static inline bool spsc_push(SpscQueue *q, const void *item) {
+    uint32_t head = q->head;
+
+    if (head - q->tail >= q->capacity) {
+        q->dropped++;
+        return false;
+    }
+    memcpy(q->items + (head & (q->capacity - 1)) * q->item_size, item, q->item_size);
+    __sync_synchronize();
+    q->head = head + 1;
+    return true;
+}
+
+// Chamado só pelo consumidor; retorna false se estiver vazia
+static inline bool spsc_pop(SpscQueue *q, void *item) {
+    uint32_t tail = q->tail;
+
+    if (q->head == tail)
+        return false;
+    __sync_synchronize();
+    memcpy(item, q->items + (tail & (q->capacity - 1)) * q->item_size, q->item_size);
+    __sync_synchronize();
+    q->tail = tail + 1;
+    return true;
+}
+
+// Chamado só pelo consumidor: o próximo item sem retirá-lo (NULL se vazia)
+static inline const void *spsc_peek(const SpscQueue *q) {
+    uint32_t tail = q->tail;
+
+    if (q->head == tail)
+        return NULL;
+    __sync_synchronize();
+    return q->items + (tail & (q->capacity - 1)) * q->item_size;
+}
+
+static inline uint32_t spsc_count(const SpscQueue *q) {
+    return q->head - q->tail;
+}
+
+#endif
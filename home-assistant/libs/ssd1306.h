@@ -6,8 +6,12 @@ extern void ssd1306_send_buffer(uint8_t ssd[], int buffer_length);
 extern void ssd1306_init();
 extern void ssd1306_scroll(bool set);
 extern void render_on_display(uint8_t *ssd, struct render_area *area);
+extern void ssd1306_render_pages(uint8_t *ssd, uint8_t first, uint8_t last);
+extern void ssd1306_render_columns(uint8_t *ssd, uint8_t page, uint8_t first, uint8_t last);
+extern void ssd1306_set_start_line(uint8_t line);
 extern void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set);
 extern void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool set);
+extern void ssd1306_draw_shaded_row(uint8_t *ssd, int y, const uint8_t *shade);
 extern void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character);
 extern void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, char *string);
 extern void ssd1306_command(ssd1306_t *ssd, uint8_t command);
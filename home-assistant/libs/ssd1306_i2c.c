@@ -85,6 +85,30 @@ void render_on_display(uint8_t *ssd, struct render_area *area) {
     ssd1306_send_buffer(ssd, area->buffer_length);
 }
 
+// Envia só as páginas first..last de um buffer da tela inteira (uma página
+// de 128 bytes leva ~3 ms no I2C a 400 kHz, a tela inteira ~25 ms)
+void ssd1306_render_pages(uint8_t *ssd, uint8_t first, uint8_t last) {
+    struct render_area area = {0, ssd1306_width - 1, first, last};
+
+    calculate_render_area_buffer_length(&area);
+    render_on_display(ssd + first * ssd1306_width, &area);
+}
+
+// Envia só as colunas first..last de uma página: a janela mínima para um
+// trecho que mudou (um byte leva ~0,2 ms com os comandos de endereço)
+void ssd1306_render_columns(uint8_t *ssd, uint8_t page, uint8_t first, uint8_t last) {
+    struct render_area area = {first, last, page, page};
+
+    calculate_render_area_buffer_length(&area);
+    render_on_display(ssd + page * ssd1306_width + first, &area);
+}
+
+// Linha da RAM exibida no topo da tela: rola a imagem verticalmente sem
+// reenviar o buffer
+void ssd1306_set_start_line(uint8_t line) {
+    ssd1306_send_command(ssd1306_set_display_start_line | (line % ssd1306_height));
+}
+
 // Determina o pixel a ser aceso (no display) de acordo com a coordenada fornecida
 void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set) {
     assert(x >= 0 && x < ssd1306_width && y >= 0 && y < ssd1306_height);
@@ -104,6 +128,27 @@ void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set) {
     ssd[byte_idx] = byte;
 }
 
+// Desenha uma linha horizontal inteira com tons de 0 (apagado) a 16 (aceso),
+// por pontilhado ordenado (matriz de Bayer 4x4)
+void ssd1306_draw_shaded_row(uint8_t *ssd, int y, const uint8_t *shade) {
+    static const uint8_t bayer[4][4] = {
+        {0, 8, 2, 10},
+        {12, 4, 14, 6},
+        {3, 11, 1, 9},
+        {15, 7, 13, 5},
+    };
+    uint8_t *row = ssd + (y / 8) * ssd1306_width;
+    uint8_t bit = 1 << (y % 8);
+    const uint8_t *threshold = bayer[y & 3];
+
+    for (int x = 0; x < ssd1306_width; x++) {
+        if (shade[x] > threshold[x & 3])
+            row[x] |= bit;
+        else
+            row[x] &= ~bit;
+    }
+}
+
 // Algoritmo de Bresenham básico
 void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool set) {
     int dx = abs(x_1 - x_0); // Deslocamentos
@@ -0,0 +1,180 @@
+#include <math.h>
+#include <string.h>
+#include "cycle_counter.h"
+#include "synth.h"
+
+static int16_t tables[SYNTH_WAVES][SYNTH_TABLE_SIZE];
+static bool tables_ready = false;
+
+// Soma de harmônicos (amplitude de cada um) normalizada para o pico de 30000
+static void build_table(int16_t *table, const float *harmonics, int count) {
+    float wave[SYNTH_TABLE_SIZE];
+    float peak = 0;
+
+    for (int i = 0; i < SYNTH_TABLE_SIZE; i++) {
+        float x = 2 * (float)M_PI * i / SYNTH_TABLE_SIZE;
+        wave[i] = 0;
+        for (int h = 0; h < count; h++)
+            wave[i] += harmonics[h] * sinf((h + 1) * x);
+        if (fabsf(wave[i]) > peak)
+            peak = fabsf(wave[i]);
+    }
+    for (int i = 0; i < SYNTH_TABLE_SIZE; i++)
+        table[i] = (int16_t)lrintf(wave[i] * 30000 / peak);
+}
+
+static void build_tables() {
+    static const float sine[] = {1};
+    static const float square[] = {1, 0, 1.0f / 3, 0, 1.0f / 5, 0, 1.0f / 7};
+    static const float saw[] = {1, 1.0f / 2, 1.0f / 3, 1.0f / 4, 1.0f / 5, 1.0f / 6, 1.0f / 7, 1.0f / 8};
+    static const float organ[] = {1, 0.5f, 0.35f, 0.25f, 0, 0.15f};
+
+    build_table(tables[SYNTH_WAVE_SINE], sine, 1);
+    build_table(tables[SYNTH_WAVE_SQUARE], square, 7);
+    build_table(tables[SYNTH_WAVE_SAW], saw, 8);
+    build_table(tables[SYNTH_WAVE_ORGAN], organ, 6);
+    tables_ready = true;
+}
+
+static const SynthInstrument default_instrument = {SYNTH_WAVE_SINE, 10, 100, 20000, 80, 12000};
+
+void synth_init(Synth *s, uint32_t sample_rate) {
+    if (!tables_ready)
+        build_tables();
+    memset(s->voices, 0, sizeof(s->voices));
+    s->instrument = &default_instrument;
+    s->sample_rate = sample_rate;
+    s->notes = 0;
+    s->cost = 0;
+    cycle_counter_init();
+}
+
+// Vale para as próximas notas; as que estão soando mantêm o timbre
+void synth_set_instrument(Synth *s, const SynthInstrument *instrument) {
+    s->instrument = instrument ? instrument : &default_instrument;
+}
+
+// Incremento de envelope por passo para percorrer range em ms
+static int32_t env_step(const Synth *s, int32_t range, uint16_t ms) {
+    uint32_t steps = (uint32_t)ms * s->sample_rate / (1000 * SYNTH_CHUNK);
+    return steps ? range / (int32_t)steps : range;
+}
+
+// Começa uma nota numa voz livre; sem voz livre, rouba a mais antiga em
+// liberação ou, se não houver, a mais antiga de todas. Retorna a voz.
+int synth_note_on(Synth *s, uint32_t millihertz) {
+    const SynthInstrument *ins = s->instrument;
+    int best = 0;
+    int best_rank = -1;
+
+    for (int i = 0; i < SYNTH_VOICES; i++) {
+        const SynthVoice *v = &s->voices[i];
+        int rank = v->stage == SYNTH_OFF ? 2 : v->stage == SYNTH_RELEASE ? 1 : 0;
+        if (rank > best_rank || (rank == best_rank && v->started < s->voices[best].started)) {
+            best = i;
+            best_rank = rank;
+        }
+    }
+
+    SynthVoice *v = &s->voices[best];
+    v->table = tables[ins->wave < SYNTH_WAVES ? ins->wave : SYNTH_WAVE_SINE];
+    v->phase = 0;
+    v->step = (uint32_t)(((uint64_t)millihertz << 32) / ((uint64_t)s->sample_rate * 1000));
+    v->env = 0;
+    v->sustain = (int32_t)ins->sustain << 8;
+    v->attack_step = env_step(s, SYNTH_ENV_ONE, ins->attack_ms);
+    v->decay_step = env_step(s, SYNTH_ENV_ONE - v->sustain, ins->decay_ms);
+    v->release_step = env_step(s, SYNTH_ENV_ONE, ins->release_ms);
+    v->volume = ins->volume;
+    v->started = s->notes++;
+    v->stage = SYNTH_ATTACK;
+    return best;
+}
+
+// As vozes tocando a frequência entram na liberação (fim de uma nota MIDI)
+void synth_note_off(Synth *s, uint32_t millihertz) {
+    uint32_t step = (uint32_t)(((uint64_t)millihertz << 32) / ((uint64_t)s->sample_rate * 1000));
+
+    for (int i = 0; i < SYNTH_VOICES; i++)
+        if (s->voices[i].stage != SYNTH_OFF && s->voices[i].step == step)
+            s->voices[i].stage = SYNTH_RELEASE;
+}
+
+// Todas as vozes entram na liberação do envelope
+void synth_release_all(Synth *s) {
+    for (int i = 0; i < SYNTH_VOICES; i++)
+        if (s->voices[i].stage != SYNTH_OFF)
+            s->voices[i].stage = SYNTH_RELEASE;
+}
+
+// Corta todas as vozes na hora
+void synth_silence(Synth *s) {
+    for (int i = 0; i < SYNTH_VOICES; i++)
+        s->voices[i].stage = SYNTH_OFF;
+}
+
+int synth_active_voices(const Synth *s) {
+    int count = 0;
+
+    for (int i = 0; i < SYNTH_VOICES; i++)
+        count += s->voices[i].stage != SYNTH_OFF;
+    return count;
+}
+
+// Avança o envelope um passo; false quando a voz terminou
+static bool advance_envelope(SynthVoice *v) {
+    switch (v->stage) {
+        case SYNTH_ATTACK:
+            v->env += v->attack_step;
+            if (v->env >= SYNTH_ENV_ONE) {
+                v->env = SYNTH_ENV_ONE;
+                v->stage = SYNTH_DECAY;
+            }
+            break;
+        case SYNTH_DECAY:
+            v->env -= v->decay_step;
+            if (v->env <= v->sustain) {
+                v->env = v->sustain;
+                v->stage = SYNTH_SUSTAIN;
+            }
+            break;
+        case SYNTH_RELEASE:
+            v->env -= v->release_step;
+            if (v->env <= 0) {
+                v->env = 0;
+                v->stage = SYNTH_OFF;
+                return false;
+            }
+            break;
+    }
+    return v->stage != SYNTH_OFF;
+}
+
+// Gera n amostras (múltiplo de SYNTH_CHUNK) com todas as vozes somadas
+void synth_render(Synth *s, int16_t *out, int n) {
+    uint32_t start = cycle_counter_now();
+    int32_t mix[SYNTH_CHUNK];
+
+    for (int c = 0; c < n; c += SYNTH_CHUNK) {
+        memset(mix, 0, sizeof(mix));
+        for (int i = 0; i < SYNTH_VOICES; i++) {
+            SynthVoice *v = &s->voices[i];
+            if (v->stage == SYNTH_OFF || !advance_envelope(v))
+                continue;
+
+            // Amplitude da voz em Q15 constante no passo
+            const int32_t amp = (int32_t)(((int64_t)v->env * v->volume) >> 23);
+            const int16_t *table = v->table;
+            uint32_t phase = v->phase;
+            const uint32_t step = v->step;
+            for (int k = 0; k < SYNTH_CHUNK; k++) {
+                mix[k] += (table[phase >> (32 - SYNTH_TABLE_BITS)] * amp) >> 15;
+                phase += step;
+            }
+            v->phase = phase;
+        }
+        for (int k = 0; k < SYNTH_CHUNK; k++)
+            out[c + k] = mix[k] > 32767 ? 32767 : mix[k] < -32768 ? -32768 : mix[k];
+    }
+    s->cost = cycle_counter_elapsed(start);
+}
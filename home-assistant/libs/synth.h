@@ -0,0 +1,72 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef synth_inc_h
+#define synth_inc_h
+
+// Sintetizador polifônico por tabela de onda para a saída PWM (pwm_audio):
+// cada voz lê uma tabela de SYNTH_TABLE_SIZE amostras com um acumulador de
+// fase de 32 bits e é multiplicada por um envelope ADSR. O envelope avança
+// uma vez a cada SYNTH_CHUNK amostras, então o laço interno por amostra é só
+// soma de fase, leitura da tabela, multiplicação e acumulação.
+
+#define SYNTH_VOICES 6
+#define SYNTH_TABLE_BITS 8
+#define SYNTH_TABLE_SIZE (1 << SYNTH_TABLE_BITS)
+#define SYNTH_CHUNK 16                 // Amostras por passo do envelope (~0,7 ms a 22 kHz)
+#define SYNTH_ENV_ONE (1 << 23)        // Envelope em Q23
+
+typedef enum {
+    SYNTH_WAVE_SINE,
+    SYNTH_WAVE_SQUARE,                 // Harmônicos ímpares até o 7º (sem aliasing nos agudos)
+    SYNTH_WAVE_SAW,                    // Harmônicos 1 a 8
+    SYNTH_WAVE_ORGAN,                  // Fundamental, oitava e quinta
+    SYNTH_WAVES
+} SynthWave;
+
+// Timbre de uma música: forma de onda e envelope
+typedef struct {
+    uint8_t wave;                      // SynthWave
+    uint16_t attack_ms, decay_ms;
+    uint16_t sustain;                  // Nível de sustentação, Q15
+    uint16_t release_ms;
+    uint16_t volume;                   // Amplitude de cada voz, Q15
+} SynthInstrument;
+
+typedef enum {
+    SYNTH_OFF,
+    SYNTH_ATTACK,
+    SYNTH_DECAY,
+    SYNTH_SUSTAIN,
+    SYNTH_RELEASE
+} SynthStage;
+
+typedef struct {
+    const int16_t *table;
+    uint32_t phase, step;              // Fase em 1/2^32 de ciclo
+    int32_t env;                       // Envelope, Q23
+    int32_t attack_step, decay_step, release_step;  // Por passo de envelope
+    int32_t sustain;
+    uint16_t volume;
+    uint8_t stage;                     // SynthStage
+    uint32_t started;                  // Ordem de início, para roubar a voz mais antiga
+} SynthVoice;
+
+typedef struct {
+    SynthVoice voices[SYNTH_VOICES];
+    const SynthInstrument *instrument;
+    uint32_t sample_rate;
+    uint32_t notes;                    // Notas iniciadas (contador livre)
+    uint32_t cost;                     // Custo do último bloco (ciclos/ns)
+} Synth;
+
+extern void synth_init(Synth *s, uint32_t sample_rate);
+extern void synth_set_instrument(Synth *s, const SynthInstrument *instrument);
+extern int synth_note_on(Synth *s, uint32_t millihertz);
+extern void synth_note_off(Synth *s, uint32_t millihertz);
+extern void synth_release_all(Synth *s);
+extern void synth_silence(Synth *s);
+extern int synth_active_voices(const Synth *s);
+extern void synth_render(Synth *s, int16_t *out, int n);
+
+#endif
@@ -0,0 +1,69 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "voice_clip.h"
+
+// Enquanto a flash é apagada ou gravada a XIP fica indisponível: as
+// interrupções deste núcleo são desligadas e, com lockout, o core1 espera
+// num laço na RAM. Uma página leva ~1 ms; um setor, ~45 ms.
+static void program(const VoiceClipWriter *writer, uint32_t offset, const uint8_t *data, size_t size,
+                    bool erase) {
+    if (writer->lockout)
+        multicore_lockout_start_blocking();
+    uint32_t irq = save_and_disable_interrupts();
+    if (erase)
+        flash_range_erase(offset, size);
+    else
+        flash_range_program(offset, data, size);
+    restore_interrupts(irq);
+    if (writer->lockout)
+        multicore_lockout_end_blocking();
+}
+
+// Apaga a região inteira (~0,7 s), um setor por vez para devolver as
+// interrupções entre os setores. Um DMA que dependa de interrupções a cada
+// poucos ms (o serviço do ADC) deve estar parado.
+void voice_clip_erase(VoiceClipWriter *writer, bool lockout) {
+    writer->pages = 0;
+    writer->lockout = lockout;
+    for (uint32_t s = 0; s < CLIP_FLASH_BYTES; s += FLASH_SECTOR_SIZE)
+        program(writer, CLIP_FLASH_OFFSET + s, NULL, FLASH_SECTOR_SIZE, true);
+}
+
+// Grava a próxima página de áudio; false se a região está cheia
+bool voice_clip_append(VoiceClipWriter *writer, const uint8_t page[FLASH_PAGE_SIZE]) {
+    uint32_t offset = FLASH_PAGE_SIZE * (1 + writer->pages);
+
+    if (offset >= CLIP_FLASH_BYTES)
+        return false;
+    program(writer, CLIP_FLASH_OFFSET + offset, page, FLASH_PAGE_SIZE, false);
+    writer->pages++;
+    return true;
+}
+
+// Grava o cabeçalho por último: um recado interrompido no meio (queda de
+// energia) continua sem cabeçalho válido
+void voice_clip_finish(VoiceClipWriter *writer, uint32_t samples, uint16_t peak) {
+    uint8_t page[FLASH_PAGE_SIZE];
+    VoiceClipHeader header = {CLIP_MAGIC, samples, CLIP_SAMPLE_RATE, peak};
+
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &header, sizeof(header));
+    program(writer, CLIP_FLASH_OFFSET, page, FLASH_PAGE_SIZE, false);
+}
+
+// Cabeçalho do recado gravado (NULL se não há)
+const VoiceClipHeader *voice_clip_header() {
+    const VoiceClipHeader *header = (const VoiceClipHeader *)(XIP_BASE + CLIP_FLASH_OFFSET);
+
+    if (header->magic != CLIP_MAGIC || header->samples > CLIP_MAX_SAMPLES)
+        return NULL;
+    return header;
+}
+
+// Áudio do recado, lido direto da flash
+const uint8_t *voice_clip_data() {
+    return (const uint8_t *)(XIP_BASE + CLIP_FLASH_OFFSET + FLASH_PAGE_SIZE);
+}
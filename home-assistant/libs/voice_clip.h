@@ -0,0 +1,37 @@
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+
+#ifndef voice_clip_inc_h
+#define voice_clip_inc_h
+
+// Recado de voz gravado numa região reservada no fim da flash: uma página de
+// cabeçalho seguida do áudio em IMA-ADPCM a CLIP_SAMPLE_RATE. A gravação é
+// feita página a página e a reprodução lê direto da flash mapeada (XIP), então
+// o recado nunca fica inteiro na RAM.
+
+#define CLIP_FLASH_BYTES (64 * 1024)
+#define CLIP_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - CLIP_FLASH_BYTES)
+#define CLIP_SAMPLE_RATE 8000
+#define CLIP_MAX_SAMPLES ((CLIP_FLASH_BYTES - FLASH_PAGE_SIZE) * 2)  // ~16 s
+#define CLIP_MAGIC 0x50494C43  // "CLIP"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t samples;      // Amostras gravadas
+    uint16_t sample_rate;
+    uint16_t peak;         // Maior amplitude, para o ganho da reprodução
+} VoiceClipHeader;
+
+typedef struct {
+    uint32_t pages;        // Páginas de áudio já gravadas
+    bool lockout;          // Pausa o core1 durante cada escrita (ele deve ter
+                           // chamado multicore_lockout_victim_init)
+} VoiceClipWriter;
+
+extern void voice_clip_erase(VoiceClipWriter *writer, bool lockout);
+extern bool voice_clip_append(VoiceClipWriter *writer, const uint8_t page[FLASH_PAGE_SIZE]);
+extern void voice_clip_finish(VoiceClipWriter *writer, uint32_t samples, uint16_t peak);
+extern const VoiceClipHeader *voice_clip_header();
+extern const uint8_t *voice_clip_data();
+
+#endif
@@ -0,0 +1,42 @@
+// Gerado pelo host/song_compiler a partir de songs/ (não editar)
+
+#include <stddef.h>
+#include "libs/song_format.h"
+
+// Frere Jacques: 48 notas, 0:19, 112 bytes
+static const uint16_t frere_jacques_melody[] = {
+    0x8064, 0xA000, 0x3C0E, 0x7F02, 0x3E0E, 0x7F02, 0x400E, 0x7F02, 0x3C0E, 0x7F02,
+    0xB002, 0xA000, 0x400E, 0x7F02, 0x410E, 0x7F02, 0x431D, 0x7F03, 0xB002, 0xA000,
+    0x4307, 0x7F01, 0x4507, 0x7F01, 0x4307, 0x7F01, 0x4107, 0x7F01, 0x400E, 0x7F02,
+    0x3C0E, 0x7F02, 0xB002, 0x3C0E, 0x7F02, 0x370E, 0x7F02, 0x3C1D, 0x7F03, 0x3C0E,
+    0x7F02, 0x370E, 0x7F02, 0x3C1D, 0xF000,
+};
+static const uint16_t frere_jacques_bass[] = {
+    0x8064, 0xA000, 0x241E, 0x7F02, 0x1F1E, 0x7F02, 0xB007, 0x241E, 0x7F02, 0x1F1E,
+    0xF000,
+};
+
+// Fur Elise: 35 notas, 0:11, 84 bytes
+static const uint16_t fur_elise_melody[] = {
+    0x807D, 0x4C08, 0x4B08, 0x4C08, 0x4B08, 0x4C08, 0x4708, 0x4A08, 0x4808, 0x4510,
+    0x7F08, 0x3C08, 0x4008, 0x4508, 0x4710, 0x7F08, 0x4008, 0x4408, 0x4708, 0x4810,
+    0x7F08, 0x4008, 0x4C08, 0x4B08, 0x4C08, 0x4B08, 0x4C08, 0x4708, 0x4A08, 0x4808,
+    0x4510, 0x7F08, 0x3C08, 0x4008, 0x4508, 0x4710, 0x7F08, 0x4008, 0x4808, 0x4708,
+    0x4520, 0xF000,
+};
+
+// Ode to Joy: 30 notas, 0:16, 64 bytes
+static const uint16_t ode_to_joy_melody[] = {
+    0x8078, 0x4010, 0x4010, 0x4110, 0x4310, 0x4310, 0x4110, 0x4010, 0x3E10, 0x3C10,
+    0x3C10, 0x3E10, 0x4010, 0x4018, 0x3E08, 0x3E20, 0x4010, 0x4010, 0x4110, 0x4310,
+    0x4310, 0x4110, 0x4010, 0x3E10, 0x3C10, 0x3C10, 0x3E10, 0x4010, 0x3E18, 0x3C08,
+    0x3C20, 0xF000,
+};
+
+const PackedSong compiled_songs[] = {
+    {"Frere Jacques", 19, frere_jacques_melody, frere_jacques_bass, 19125},
+    {"Fur Elise", 80, fur_elise_melody, NULL, 11520},
+    {"Ode to Joy", 80, ode_to_joy_melody, NULL, 16000},
+};
+
+const int compiled_song_count = 3;
@@ -24,8 +24,10 @@
 #define MIC_PIN 28  
 #define MIC_CHANNEL 2
 #define OFFSET 2048      // ADC Pico W vai de 0 a 4095, offset no meio
-#define CLAP_THRESHOLD 0.30 
-#define NOISE_THRESHOLD 0.70
+// Limiares do esboço na escala VU (0 a 1) de get_mean_vu_value; o firmware
+// usa CLAP_THRESHOLD/NOISE_THRESHOLD de libs/sound_detector.h, em contagens do ADC
+#define VU_CLAP_LEVEL 0.30
+#define VU_NOISE_LEVEL 0.70
  
 // Configuração da Matriz de LEDs
 #define LED_PIN 7       // GPIO do NeoPixel
@@ -116,7 +118,7 @@ float get_mean_vu_value(int n) {
 bool detect_double_clap() {
     float volume_level = get_mean_vu_value(10);
     // printf("Mean VU Level %.2f\n", volume_level);
-    if (volume_level > CLAP_THRESHOLD && volume_level < CLAP_THRESHOLD + 0.2) {
+    if (volume_level > VU_CLAP_LEVEL && volume_level < VU_CLAP_LEVEL + 0.2) {
         absolute_time_t now = get_absolute_time();
         int64_t time_diff = absolute_time_diff_us(last_clap_time, now) / 1000;
         
@@ -154,7 +156,7 @@ void activate_alarm() {
 bool detect_loud_noise() {
     float volume_level = get_mean_vu_value(25);
     // printf("Mean VU Level %.2f\n", volume_level);
-    if (volume_level > NOISE_THRESHOLD) {
+    if (volume_level > VU_NOISE_LEVEL) {
         // absolute_time_t now = get_absolute_time();
         // int64_t time_diff = absolute_time_diff_us(last_noise_time, now) / 1000;
         